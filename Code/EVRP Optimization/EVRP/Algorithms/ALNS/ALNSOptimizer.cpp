@@ -0,0 +1,442 @@
+#include "ALNSOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../../SolutionSet.h"
+#include "../Savings/SavingsOptimizer.h"
+
+/**
+ * \brief Switches from simulated annealing to another acceptance criterion, see ALNSAcceptance.
+ */
+void ALNSOptimizer::SetAcceptance(const ALNSAcceptance criterion)
+{
+	acceptance = criterion;
+	SetHyperParameters({string("Acceptance: ") + (acceptance == SimulatedAnnealing ? "Simulated Annealing" : "Record-to-Record Travel")});
+}
+
+/**
+ * \brief Improves a solution with the Adaptive Large Neighborhood Search of Ropke and Pisinger (2006).
+ * Every iteration takes a number of customers out of the current tour with one of the destroy operators, puts them
+ * back with one of the repair operators, and moves to the new tour if the acceptance criterion takes it. The operators
+ * are drawn by roulette wheel, and every #ALNS_SEGMENT_LENGTH iterations their weights move towards the average score
+ * they got in the last segment, so the operators that keep finding good tours on this instance get used more.
+ *
+ * The repair operators rank insertion points by how much longer they make the tour in a straight line, which only takes
+ * the distances to the customers in front of and behind the point, so it is O(1) per point. Only the points next to the
+ * customers on the candidate list of the customer being inserted (ProblemDefinition::GetNeighbors) and at the ends of the
+ * tour are looked at. The threshold a new tour has to beat to be accepted is drawn before it is evaluated, and the
+ * evaluation resumes from the checkpoint of the current tour in front of the first change and stops as soon as the
+ * threshold is out of reach, see RouteEvaluator::EvaluateIncremental. Most iterations only simulate part of a tour.
+ *
+ * The search starts from the solution given to SetInitialSolution, or else from the best Clarke-Wright savings solution.
+ * \param best_solution
+ */
+void ALNSOptimizer::Optimize(solution &best_solution)
+{
+	SetHyperParameters({string("Random Seed: ") + to_string(random_seed)});
+	const vector<Node> &all_nodes = problem_data->GetAllNodes();
+	const int customer_count = static_cast<int>(problem_data->GetCustomerNodes().size());
+	RandomGenerator generator(random_seed, 0);
+
+	max_distance = 1.f;
+	for (const auto &from : all_nodes)
+	{
+		for (const auto &to : all_nodes)
+		{
+			max_distance = max(max_distance, problem_data->Distance(from, to));
+		}
+	}
+	time_horizon = max(1.f, problem_data->GetDepotNode().due_date);
+
+	solution start = initial_solution;
+	if (start.tour.empty())
+	{
+		SavingsOptimizer savings(problem_data);
+		savings.Optimize(start);
+	}
+
+	vector<int> current_tour = start.tour;
+	RouteTrace current_trace;
+	RouteTrace candidate_trace;
+	float current_distance = evaluator.EvaluateIncremental(current_tour, nullptr, 0, scratch, current_trace).distance;
+	solution best = {current_tour, current_distance};
+
+	const int min_removed = min(customer_count, max(1, static_cast<int>(ALNS_MIN_REMOVAL * customer_count)));
+	const int max_removed = max(min_removed, min(ALNS_MAX_REMOVED_CUSTOMERS, static_cast<int>(ALNS_MAX_REMOVAL * customer_count)));
+
+	vector<float> destroy_weights(DestroyOperatorCount, 1.f);
+	vector<float> destroy_scores(DestroyOperatorCount, 0.f);
+	vector<int> destroy_uses(DestroyOperatorCount, 0);
+	vector<float> repair_weights(RepairOperatorCount, 1.f);
+	vector<float> repair_scores(RepairOperatorCount, 0.f);
+	vector<int> repair_uses(RepairOperatorCount, 0);
+
+	//a tour ALNS_START_WORSENING worse than the first one is accepted half the time at the start
+	double temperature = -ALNS_START_WORSENING * current_distance / log(0.5);
+	const double cooling = pow(static_cast<double>(ALNS_END_TEMPERATURE_RATIO), 1.0 / max(1, iterations));
+
+	position_of.assign(problem_data->GetNodeCount(), -1);
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		const auto destroy = static_cast<ALNSDestroyOperator>(SelectOperator(destroy_weights, generator));
+		const auto repair = static_cast<ALNSRepairOperator>(SelectOperator(repair_weights, generator));
+
+		candidate.assign(current_tour.begin(), current_tour.end());
+		for (int position = 0; position < static_cast<int>(candidate.size()); position++)
+		{
+			position_of[candidate[position]] = position;
+		}
+		removed.clear();
+		Destroy(destroy, generator.NextInt(min_removed, max_removed), generator);
+		Repair(repair == GreedyRepair ? 1 : repair == Regret2Repair ? 2 : 3);
+
+		//the threshold is drawn up front, so the evaluation can stop as soon as the tour can't be accepted anymore
+		const float threshold = acceptance == SimulatedAnnealing
+			? current_distance - static_cast<float>(temperature * log(1.0 - generator.NextDouble()))
+			: max(current_distance, best.distance * (1.f + ALNS_RECORD_DEVIATION));
+		temperature *= cooling;
+
+		//a repair that put every customer back where it was doesn't need to be evaluated, and isn't worth a score
+		const int first_changed = static_cast<int>(mismatch(candidate.begin(), candidate.end(), current_tour.begin()).first - candidate.begin());
+		float score = 0.f;
+		if (first_changed < static_cast<int>(candidate.size()))
+		{
+			const EvaluationResult result = evaluator.EvaluateIncremental(candidate, &current_trace, first_changed, scratch, candidate_trace, threshold);
+			if (!result.dominated && result.distance < threshold)
+			{
+				if (result.distance < best.distance)
+				{
+					best = {candidate, result.distance};
+					score = ALNS_SCORE_NEW_BEST;
+				}
+				else
+				{
+					score = result.distance < current_distance ? ALNS_SCORE_IMPROVED : ALNS_SCORE_ACCEPTED;
+				}
+				current_tour.swap(candidate);
+				swap(current_trace, candidate_trace);
+				current_distance = result.distance;
+			}
+		}
+
+		destroy_scores[destroy] += score;
+		destroy_uses[destroy]++;
+		repair_scores[repair] += score;
+		repair_uses[repair]++;
+		if ((iteration + 1) % ALNS_SEGMENT_LENGTH == 0)
+		{
+			UpdateWeights(destroy_weights, destroy_scores, destroy_uses);
+			UpdateWeights(repair_weights, repair_scores, repair_uses);
+		}
+		if ((iteration + 1) % max(1, iterations / 10) == 0)
+		{
+			cout << "ALNS iteration " << iteration + 1 << ": current " << current_distance << ", best " << best.distance << endl;
+		}
+	}
+
+	cout << "ALNS operator weights:";
+	for (int destroy = 0; destroy < DestroyOperatorCount; destroy++)
+	{
+		cout << " " << GetDestroyOperatorName(static_cast<ALNSDestroyOperator>(destroy)) << " " << destroy_weights[destroy];
+	}
+	for (int repair = 0; repair < RepairOperatorCount; repair++)
+	{
+		cout << " " << GetRepairOperatorName(static_cast<ALNSRepairOperator>(repair)) << " " << repair_weights[repair];
+	}
+	cout << endl;
+
+	best_solution = best;
+	found_tours->AddSolutionToSet(best_solution);
+}
+
+const char *ALNSOptimizer::GetDestroyOperatorName(const ALNSDestroyOperator destroy)
+{
+	switch (destroy)
+	{
+	case RandomRemoval: return "Random";
+	case WorstRemoval: return "Worst";
+	case RelatedRemoval: return "Related";
+	case RouteRemoval: return "Route";
+	case DestroyOperatorCount: break;
+	}
+	return "Unknown";
+}
+
+const char *ALNSOptimizer::GetRepairOperatorName(const ALNSRepairOperator repair)
+{
+	switch (repair)
+	{
+	case GreedyRepair: return "Greedy";
+	case Regret2Repair: return "Regret-2";
+	case Regret3Repair: return "Regret-3";
+	case RepairOperatorCount: break;
+	}
+	return "Unknown";
+}
+
+/**
+ * \brief Takes customers out of the candidate tour into the removed list with the given operator.
+ * \param destroy The destroy operator
+ * \param count The number of customers to remove, the route removal takes a whole route instead
+ * \param generator The random stream of the search
+ */
+void ALNSOptimizer::Destroy(const ALNSDestroyOperator destroy, const int count, RandomGenerator &generator)
+{
+	switch (destroy)
+	{
+	case RandomRemoval:
+		RemoveRandom(count, generator);
+		break;
+	case WorstRemoval:
+		RemoveWorst(count, generator);
+		break;
+	case RelatedRemoval:
+		RemoveRelated(count, generator);
+		break;
+	case RouteRemoval:
+		RemoveRoute(generator);
+		break;
+	case DestroyOperatorCount:
+		break;
+	}
+}
+
+void ALNSOptimizer::RemoveRandom(const int count, RandomGenerator &generator)
+{
+	for (int k = 0; k < count && !candidate.empty(); k++)
+	{
+		Remove(candidate[generator.NextInt(0, static_cast<int>(candidate.size()) - 1)]);
+	}
+}
+
+/**
+ * \brief Removes the customers that make the tour the longest in a straight line, compared to driving past them.
+ * The choice is skewed towards the worst ones by #ALNS_REMOVAL_RANDOMNESS rather than always taking them, so the same
+ * customers don't get taken out every time.
+ */
+void ALNSOptimizer::RemoveWorst(const int count, RandomGenerator &generator)
+{
+	const int depot = problem_data->GetDepotNode().index;
+	removal_order.clear();
+	for (int position = 0; position < static_cast<int>(candidate.size()); position++)
+	{
+		const int before = position == 0 ? depot : candidate[position - 1];
+		const int after = position + 1 == static_cast<int>(candidate.size()) ? depot : candidate[position + 1];
+		const int customer = candidate[position];
+		const float gain = problem_data->Distance(before, customer) + problem_data->Distance(customer, after) - problem_data->Distance(before, after);
+		removal_order.emplace_back(-gain, customer);
+	}
+	sort(removal_order.begin(), removal_order.end());
+
+	for (int k = 0; k < count && !removal_order.empty(); k++)
+	{
+		const int pick = static_cast<int>(pow(generator.NextDouble(), ALNS_REMOVAL_RANDOMNESS) * removal_order.size());
+		Remove(removal_order[pick].second);
+		removal_order.erase(removal_order.begin() + pick);
+	}
+}
+
+/**
+ * \brief Removes customers that are related to each other (Shaw, 1998), so the repair can rearrange them among themselves.
+ * Starting from a random customer, every next one is picked from the candidate list of a customer that has already been
+ * removed, ranked by the distance between them, the difference between their ready times and the difference between
+ * their demands, each scaled to the range of the instance.
+ */
+void ALNSOptimizer::RemoveRelated(const int count, RandomGenerator &generator)
+{
+	const int neighbor_count = problem_data->GetNeighborCount();
+	const float capacity = static_cast<float>(max(1, problem_data->GetVehicleParameters().load_capacity));
+
+	Remove(candidate[generator.NextInt(0, static_cast<int>(candidate.size()) - 1)]);
+	while (static_cast<int>(removed.size()) < count && !candidate.empty())
+	{
+		const Node &related_to = problem_data->GetNodeFromIndex(removed[generator.NextInt(0, static_cast<int>(removed.size()) - 1)]);
+		const int *neighbors = problem_data->GetNeighbors(related_to.index);
+
+		removal_order.clear();
+		for (int k = 0; k < neighbor_count; k++)
+		{
+			if (position_of[neighbors[k]] < 0) continue;
+			const Node &neighbor = problem_data->GetNodeFromIndex(neighbors[k]);
+			const float relatedness = problem_data->Distance(related_to, neighbor) / max_distance
+				+ fabs(related_to.ready_time - neighbor.ready_time) / time_horizon
+				+ static_cast<float>(abs(related_to.demand - neighbor.demand)) / capacity;
+			removal_order.emplace_back(relatedness, neighbor.index);
+		}
+
+		//all of its close customers are gone already, so the search jumps somewhere else
+		if (removal_order.empty())
+		{
+			Remove(candidate[generator.NextInt(0, static_cast<int>(candidate.size()) - 1)]);
+			continue;
+		}
+
+		sort(removal_order.begin(), removal_order.end());
+		const int pick = static_cast<int>(pow(generator.NextDouble(), ALNS_REMOVAL_RANDOMNESS) * removal_order.size());
+		Remove(removal_order[pick].second);
+	}
+}
+
+/**
+ * \brief Removes every customer of one route, with the routes found the same way the greedy split finds them.
+ */
+void ALNSOptimizer::RemoveRoute(RandomGenerator &generator)
+{
+	const int capacity = problem_data->GetVehicleParameters().load_capacity;
+
+	route_starts.assign(1, 0);
+	int load = 0;
+	for (int position = 0; position < static_cast<int>(candidate.size()); position++)
+	{
+		const int demand = problem_data->GetNodeFromIndex(candidate[position]).demand;
+		if (load + demand > capacity && position > route_starts.back())
+		{
+			route_starts.push_back(position);
+			load = 0;
+		}
+		load += demand;
+	}
+	route_starts.push_back(static_cast<int>(candidate.size()));
+
+	const int route = generator.NextInt(0, static_cast<int>(route_starts.size()) - 2);
+	for (int k = route_starts[route + 1] - route_starts[route]; k > 0; k--)
+	{
+		Remove(candidate[route_starts[route]]);
+	}
+}
+
+/**
+ * \brief Takes a customer out of the candidate tour and puts it on the removed list.
+ */
+void ALNSOptimizer::Remove(const int customer)
+{
+	const int position = position_of[customer];
+	candidate.erase(candidate.begin() + position);
+	for (int i = position; i < static_cast<int>(candidate.size()); i++)
+	{
+		position_of[candidate[i]] = i;
+	}
+	position_of[customer] = -1;
+	removed.push_back(customer);
+}
+
+/**
+ * \brief Puts all removed customers back into the candidate tour, one at a time.
+ * With a regret of 1 this is the greedy repair: the customer with the cheapest insertion goes first. Otherwise the
+ * customer that would lose the most if it missed out on its best insertion point goes first, measured by how much more
+ * its next regret - 1 best points cost. Either way the customer goes in at its best point, and the costs of the others
+ * are worked out again against the changed tour.
+ * \param regret The number of insertion points compared per customer
+ */
+void ALNSOptimizer::Repair(const int regret)
+{
+	while (!removed.empty())
+	{
+		int best_index = -1;
+		float best_regret = 0.f;
+		float best_cost = 0.f;
+		int best_position = 0;
+		for (int index = 0; index < static_cast<int>(removed.size()); index++)
+		{
+			FindInsertions(removed[index], regret);
+			const float cost = insertions.front().cost;
+			float customer_regret = 0.f;
+			for (int h = 1; h < regret; h++)
+			{
+				//a customer with fewer insertion points than the regret compares with its last one
+				customer_regret += insertions[min(h, static_cast<int>(insertions.size()) - 1)].cost - cost;
+			}
+
+			if (best_index == -1 || customer_regret > best_regret || (customer_regret == best_regret && cost < best_cost))
+			{
+				best_index = index;
+				best_regret = customer_regret;
+				best_cost = cost;
+				best_position = insertions.front().position;
+			}
+		}
+
+		const int customer = removed[best_index];
+		removed.erase(removed.begin() + best_index);
+		candidate.insert(candidate.begin() + best_position, customer);
+		for (int i = best_position; i < static_cast<int>(candidate.size()); i++)
+		{
+			position_of[candidate[i]] = i;
+		}
+	}
+}
+
+/**
+ * \brief Finds the cheapest points to insert a customer at, next to the customers on its candidate list or at either end of the tour.
+ * \param customer The customer to insert
+ * \param regret The number of the cheapest points that are needed, #insertions holds at least those, cheapest first
+ */
+void ALNSOptimizer::FindInsertions(const int customer, const int regret)
+{
+	const int neighbor_count = problem_data->GetNeighborCount();
+	const int *neighbors = problem_data->GetNeighbors(customer);
+	const int end = static_cast<int>(candidate.size());
+
+	insertions.clear();
+	insertions.push_back({InsertionCost(customer, 0), 0});
+	if (end > 0) insertions.push_back({InsertionCost(customer, end), end});
+	for (int k = 0; k < neighbor_count; k++)
+	{
+		const int position = position_of[neighbors[k]];
+		if (position < 0) continue;
+		insertions.push_back({InsertionCost(customer, position), position});
+		insertions.push_back({InsertionCost(customer, position + 1), position + 1});
+	}
+
+	//the same point can come up twice, from the customers on both sides of it, with the same cost
+	const auto cheaper = [](const Insertion &a, const Insertion &b) { return a.cost < b.cost || (a.cost == b.cost && a.position < b.position); };
+	const int needed = min(static_cast<int>(insertions.size()), 2 * regret);
+	partial_sort(insertions.begin(), insertions.begin() + needed, insertions.end(), cheaper);
+	insertions.resize(needed);
+	insertions.erase(unique(insertions.begin(), insertions.end(), [](const Insertion &a, const Insertion &b) { return a.position == b.position; }), insertions.end());
+}
+
+/**
+ * \brief How much longer the candidate tour gets in a straight line if a customer is inserted in front of the given position.
+ */
+float ALNSOptimizer::InsertionCost(const int customer, const int position) const
+{
+	const int depot = problem_data->GetDepotNode().index;
+	const int before = position == 0 ? depot : candidate[position - 1];
+	const int after = position == static_cast<int>(candidate.size()) ? depot : candidate[position];
+	return problem_data->Distance(before, customer) + problem_data->Distance(customer, after) - problem_data->Distance(before, after);
+}
+
+/**
+ * \brief Draws an operator by roulette wheel, with a chance proportional to its weight.
+ */
+int ALNSOptimizer::SelectOperator(const vector<float> &weights, RandomGenerator &generator)
+{
+	float total = 0.f;
+	for (const float weight : weights)
+	{
+		total += weight;
+	}
+
+	float spin = static_cast<float>(generator.NextDouble()) * total;
+	for (int op = 0; op < static_cast<int>(weights.size()); op++)
+	{
+		spin -= weights[op];
+		if (spin < 0.f) return op;
+	}
+	return static_cast<int>(weights.size()) - 1;
+}
+
+/**
+ * \brief Moves the weight of every operator that was used in the last segment towards its average score, and starts a new segment.
+ */
+void ALNSOptimizer::UpdateWeights(vector<float> &weights, vector<float> &scores, vector<int> &uses)
+{
+	for (size_t op = 0; op < weights.size(); op++)
+	{
+		if (uses[op] > 0) weights[op] = (1.f - ALNS_REACTION_FACTOR) * weights[op] + ALNS_REACTION_FACTOR * scores[op] / static_cast<float>(uses[op]);
+		scores[op] = 0.f;
+		uses[op] = 0;
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "../AlgorithmBase.h"
+#include "../../RandomGenerator.h"
+
+constexpr int ALNS_ITERATIONS = 50000; /*!< Number of destroy and repair iterations*/
+constexpr float ALNS_MIN_REMOVAL = 0.05f; /*!< The fewest customers a destroy operator removes, as a fraction of all customers*/
+constexpr float ALNS_MAX_REMOVAL = 0.3f; /*!< The most customers a destroy operator removes, as a fraction of all customers*/
+constexpr int ALNS_MAX_REMOVED_CUSTOMERS = 50; /*!< Upper limit on the customers removed at once, however large the instance*/
+constexpr int ALNS_SEGMENT_LENGTH = 100; /*!< Number of iterations between updates of the operator weights*/
+constexpr float ALNS_REACTION_FACTOR = 0.1f; /*!< How much of an operator's weight is replaced by its score of the last segment*/
+constexpr float ALNS_SCORE_NEW_BEST = 33.f; /*!< Score for an operator pair that found a new best solution*/
+constexpr float ALNS_SCORE_IMPROVED = 9.f; /*!< Score for an operator pair that improved on the current solution*/
+constexpr float ALNS_SCORE_ACCEPTED = 13.f; /*!< Score for an operator pair whose worse solution was accepted anyway*/
+constexpr float ALNS_START_WORSENING = 0.05f; /*!< Simulated annealing starts out accepting a solution this much worse than the first one half of the time*/
+constexpr float ALNS_END_TEMPERATURE_RATIO = 0.001f; /*!< The temperature at the last iteration, as a fraction of the starting temperature*/
+constexpr float ALNS_RECORD_DEVIATION = 0.01f; /*!< Record-to-record travel accepts solutions up to this much worse than the best one*/
+constexpr int ALNS_REMOVAL_RANDOMNESS = 3; /*!< Exponent that skews worst and related removal towards their first choices, higher is more deterministic*/
+
+/**
+* The ways an ALNS iteration takes customers out of the current solution.
+*/
+enum ALNSDestroyOperator
+{
+	RandomRemoval, /*!< Customers picked at random*/
+	WorstRemoval, /*!< The customers whose removal shortens the tour the most*/
+	RelatedRemoval, /*!< Customers that are close to each other in place, demand and time window (Shaw, 1998)*/
+	RouteRemoval, /*!< All customers of one route*/
+	DestroyOperatorCount
+};
+
+/**
+* The ways an ALNS iteration puts the removed customers back.
+*/
+enum ALNSRepairOperator
+{
+	GreedyRepair, /*!< The customer with the cheapest insertion first*/
+	Regret2Repair, /*!< The customer that loses the most if it doesn't get its best insertion point first, comparing with the second best*/
+	Regret3Repair, /*!< The same as Regret2Repair, but over the three best insertion points*/
+	RepairOperatorCount
+};
+
+/**
+* Which worse solutions ALNS moves to.
+*/
+enum ALNSAcceptance
+{
+	SimulatedAnnealing, /*!< Accepts a solution that is worse by delta with probability exp(-delta / temperature), with the temperature cooling down geometrically*/
+	RecordToRecord /*!< Accepts any solution within #ALNS_RECORD_DEVIATION of the best one*/
+};
+
+class ALNSOptimizer : public AlgorithmBase
+{
+public:
+	ALNSOptimizer(const ProblemDefinition *data) :
+		AlgorithmBase("Adaptive Large Neighborhood Search", data)
+	{
+		vector<string> hyper_parameters;
+
+		hyper_parameters.push_back(string("Iterations: ") + to_string(ALNS_ITERATIONS));
+		hyper_parameters.push_back(string("Removal: ") + to_string(ALNS_MIN_REMOVAL) + " to " + to_string(ALNS_MAX_REMOVAL));
+		hyper_parameters.push_back(string("Segment Length: ") + to_string(ALNS_SEGMENT_LENGTH));
+		hyper_parameters.push_back(string("Reaction Factor: ") + to_string(ALNS_REACTION_FACTOR));
+
+		SetHyperParameters(hyper_parameters);
+	}
+
+	void SetIterations(const int count) { iterations = count; }
+	void SetRandomSeed(const uint64_t seed) { random_seed = seed; }
+	void SetAcceptance(ALNSAcceptance criterion);
+	void SetInitialSolution(const solution &initial) { initial_solution = initial; }
+	void Optimize(solution &best_solution) override;
+
+	static const char *GetDestroyOperatorName(ALNSDestroyOperator destroy);
+	static const char *GetRepairOperatorName(ALNSRepairOperator repair);
+
+private:
+	/** A place the repair could put a removed customer back, in front of the customer at position in the tour */
+	struct Insertion
+	{
+		float cost;
+		int position;
+	};
+
+	void Destroy(ALNSDestroyOperator destroy, int count, RandomGenerator &generator);
+	void RemoveRandom(int count, RandomGenerator &generator);
+	void RemoveWorst(int count, RandomGenerator &generator);
+	void RemoveRelated(int count, RandomGenerator &generator);
+	void RemoveRoute(RandomGenerator &generator);
+	void Remove(int customer);
+	void Repair(int regret);
+	void FindInsertions(int customer, int regret);
+	float InsertionCost(int customer, int position) const;
+	static int SelectOperator(const vector<float> &weights, RandomGenerator &generator);
+	static void UpdateWeights(vector<float> &weights, vector<float> &scores, vector<int> &uses);
+
+	int iterations = ALNS_ITERATIONS;
+	uint64_t random_seed = RandomGenerator::GetRunSeed(); /*!< Seeds the random stream, so runs with the same seed are reproducible*/
+	ALNSAcceptance acceptance = SimulatedAnnealing;
+	solution initial_solution; /*!< The solution to start from, or an empty one to start from the best Clarke-Wright savings solution*/
+
+	vector<int> candidate; /*!< The tour being destroyed and repaired*/
+	vector<int> position_of; /*!< The position of every customer in #candidate by node index, -1 if it has been removed*/
+	vector<int> removed; /*!< The customers taken out of #candidate, in the order they were removed*/
+	vector<Insertion> insertions; /*!< The insertion points of the customer being looked at, best first*/
+	vector<pair<float, int>> removal_order; /*!< Customers sorted by how much is gained by removing them*/
+	vector<int> route_starts; /*!< The positions in #candidate where a new route starts, and its end*/
+	float max_distance = 1.f; /*!< The largest distance between two nodes, scales the distance in the relatedness*/
+	float time_horizon = 1.f; /*!< The end of the depot's time window, scales the time windows in the relatedness*/
+};
@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include <iostream>
-#include "../Vehicle.h"
+#include "../RouteCache.h"
+#include "../RouteEvaluator.h"
 #include "../SolutionSet.h"
 
 class AlgorithmBase
@@ -8,11 +9,9 @@ class AlgorithmBase
 public:
    AlgorithmBase();
    
-   explicit AlgorithmBase(const string &algorithm_name, const ProblemDefinition* data)
+   explicit AlgorithmBase(const string &algorithm_name, const ProblemDefinition* data) :
+      problem_data(data), evaluator(*data), scratch(data)
    {
-      problem_data = data;
-      vehicle = new Vehicle(problem_data);
-
       name = algorithm_name;
       hyper_parameters.clear();
 
@@ -22,24 +21,64 @@ public:
 
    virtual ~AlgorithmBase()
    {
-      free(vehicle);
+      delete found_tours;
    }
    virtual void Optimize(solution &best_solution) = 0;
    string GetName() { return name; }
    vector<string> GetHyperParameters() { return hyper_parameters; }
    SolutionSet* GetFoundTours() const { return found_tours; }
+
+   /** Chooses where the evaluator splits tours into routes, see RouteEvaluator::SetSplitStrategy. Has to be called before Optimize */
+   void SetSplitStrategy(const SplitStrategy strategy)
+   {
+      evaluator.SetSplitStrategy(strategy);
+      SetHyperParameters({string("Split: ") + RouteEvaluator::GetSplitStrategyName(strategy)});
+   }
+
+   /** Chooses where the evaluator inserts charging stops, see RouteEvaluator::SetChargingStrategy. Has to be called before Optimize */
+   void SetChargingStrategy(const ChargingStrategy strategy)
+   {
+      evaluator.SetChargingStrategy(strategy);
+      SetHyperParameters({string("Charging: ") + RouteEvaluator::GetChargingStrategyName(strategy)});
+   }
+
+   /** Sets how many threads Optimize runs on, values below 1 use every hardware thread. Algorithms that only run on the calling thread ignore it */
+   virtual void SetWorkerCount(int) {}
+
+   /** The number of threads Optimize runs on, see SetWorkerCount */
+   virtual int GetWorkerCount() const { return 1; }
+
+   /** Memoizes the routes the evaluator drives, see RouteEvaluator::EnableRouteCache. Has to be called before Optimize */
+   void EnableRouteCache(const size_t capacity = DEFAULT_ROUTE_CACHE_CAPACITY)
+   {
+      evaluator.EnableRouteCache(capacity);
+      SetHyperParameters({"Route cache: " + to_string(capacity)});
+   }
    
 protected:
    const ProblemDefinition *problem_data;
-   Vehicle *vehicle;
+   RouteEvaluator evaluator; /*!< Fitness function, only configured before Optimize and read-only after that, so it is safe to share between threads*/
+   mutable EvaluationScratch scratch; /*!< Scratch buffers for evaluations made on the algorithm's own thread, mutable since they hold no logical state*/
 
    SolutionSet* found_tours;
    
+   /** Logs each "Key: value" parameter, replacing an earlier one with the same key so setters and Optimize can be called repeatedly */
    void SetHyperParameters(const vector<string> &params)
    {
       for(const auto &iter : params)
       {
-         hyper_parameters.push_back(iter);
+         const string key = iter.substr(0, iter.find(": "));
+         bool replaced = false;
+         for(auto &existing : hyper_parameters)
+         {
+            if(existing.compare(0, existing.find(": "), key) == 0)
+            {
+               existing = iter;
+               replaced = true;
+               break;
+            }
+         }
+         if(!replaced) hyper_parameters.push_back(iter);
       }
    }
 
@@ -0,0 +1,294 @@
+#include "CrossoverOperators.h"
+
+#include <algorithm>
+#include "../../HelperFunctions.h"
+
+/**
+* Breeds a child with the chosen crossover.
+*
+* @param crossover Which crossover to use
+* @param parent_1 The tour of the first parent
+* @param parent_2 The tour of the second parent
+* @param tour_length The number of customers in both tours
+* @param child Receives the child's tour, must have room for tour_length genes
+* @param generator The random number stream of the worker doing the crossover
+* @param scratch The crossover scratch of the worker doing the crossover
+*/
+void CrossoverOperators::Apply(const CrossoverOperator crossover, const int *parent_1, const int *parent_2, const int tour_length, int *child,
+	RandomGenerator &generator, CrossoverScratch &scratch)
+{
+	switch (crossover)
+	{
+	case SinglePointCrossover:
+		SinglePoint(parent_1, parent_2, tour_length, child, generator, scratch);
+		break;
+	case OrderCrossover:
+		Order(parent_1, parent_2, tour_length, child, generator, scratch);
+		break;
+	case PartiallyMappedCrossover:
+		PartiallyMapped(parent_1, parent_2, tour_length, child, generator, scratch);
+		break;
+	case EdgeRecombinationCrossover:
+		EdgeRecombination(parent_1, parent_2, tour_length, child, generator, scratch);
+		break;
+	}
+}
+
+/**
+* Single Point Crossover, where a random number of elements are taken from the front of the first
+* parent, and the rest of the child is filled with the missing elements in the order of the second parent.
+*
+* This is the crossover the Genetic Algorithm has always used, and it draws the same crossover point
+* and breeds the same children as before. It only no longer searches the child for every gene of the second parent.
+*/
+void CrossoverOperators::SinglePoint(const int *parent_1, const int *parent_2, const int tour_length, int *child,
+	RandomGenerator &generator, CrossoverScratch &scratch)
+{
+	BeginChild(scratch);
+	const int crossover_point = HelperFunctions::RandomNumberGenerator(0, tour_length, generator);
+	for (int i = 0; i < crossover_point; i++)
+	{
+		child[i] = parent_1[i];
+		scratch.seen[parent_1[i]] = scratch.stamp;
+	}
+
+	int child_index = crossover_point;
+	for (int i = 0; i < tour_length; i++)
+	{
+		const int element = parent_2[i];
+		if (scratch.seen[element] != scratch.stamp)
+		{
+			child[child_index] = element;
+			++child_index;
+		}
+	}
+}
+
+/**
+* Order Crossover (OX). A random slice of the first parent is copied into the child at the same positions.
+* The rest of the child is filled starting right after the slice and wrapping around, with the missing
+* elements in the order they appear in the second parent, also starting right after the slice.
+* This keeps the relative order of both parents, but not the absolute positions of the second parent.
+*/
+void CrossoverOperators::Order(const int *parent_1, const int *parent_2, const int tour_length, int *child,
+	RandomGenerator &generator, CrossoverScratch &scratch)
+{
+	if (tour_length == 0) return;
+
+	BeginChild(scratch);
+	int slice_start, slice_end;
+	DrawSlice(tour_length, generator, slice_start, slice_end);
+	for (int i = slice_start; i <= slice_end; i++)
+	{
+		child[i] = parent_1[i];
+		scratch.seen[parent_1[i]] = scratch.stamp;
+	}
+
+	int child_index = slice_end + 1 == tour_length ? 0 : slice_end + 1;
+	int parent_index = child_index;
+	for (int i = 0; i < tour_length; i++)
+	{
+		const int element = parent_2[parent_index];
+		if (scratch.seen[element] != scratch.stamp)
+		{
+			child[child_index] = element;
+			if (++child_index == tour_length) child_index = 0;
+		}
+		if (++parent_index == tour_length) parent_index = 0;
+	}
+}
+
+/**
+* Partially Mapped Crossover (PMX). A random slice of the first parent is copied into the child at the
+* same positions, and every other position gets the element of the second parent at that position. If that
+* element is already in the slice, the slice maps it to the element of the second parent at the position it
+* has in the first parent, until an element turns up that isn't in the slice yet. Unlike OX, this keeps as
+* many absolute positions of the second parent as possible.
+*
+* The mapping chains never share an element, so all of them together visit each position at most once.
+*/
+void CrossoverOperators::PartiallyMapped(const int *parent_1, const int *parent_2, const int tour_length, int *child,
+	RandomGenerator &generator, CrossoverScratch &scratch)
+{
+	if (tour_length == 0) return;
+
+	BeginChild(scratch);
+	int slice_start, slice_end;
+	DrawSlice(tour_length, generator, slice_start, slice_end);
+	for (int i = 0; i < tour_length; i++)
+	{
+		scratch.position[parent_1[i]] = i;
+	}
+	for (int i = slice_start; i <= slice_end; i++)
+	{
+		child[i] = parent_1[i];
+		scratch.seen[parent_1[i]] = scratch.stamp;
+	}
+
+	for (int i = 0; i < tour_length; i++)
+	{
+		if (i == slice_start)
+		{
+			i = slice_end;
+			continue;
+		}
+		int element = parent_2[i];
+		while (scratch.seen[element] == scratch.stamp)
+		{
+			element = parent_2[scratch.position[element]];
+		}
+		child[i] = element;
+	}
+}
+
+/**
+* Edge Recombination Crossover (ERX). The two parents are merged into a table of the edges each customer has
+* in either of them, with the tours treated as closed loops through the depot. The child starts at the first
+* customer of one of the parents, and then keeps moving to whichever unvisited neighbor in the edge table
+* has the fewest unvisited neighbors left itself, with ties broken at random, so the customers that are
+* about to run out of edges are used up first. Only when the current customer has no unvisited neighbors
+* left does the child jump to a random unvisited customer.
+*
+* Every customer has at most #ERX_MAX_NEIGHBORS entries in the edge table, and the unvisited customers are
+* kept in an array that a customer can be swapped out of, so each step takes constant time.
+*/
+void CrossoverOperators::EdgeRecombination(const int *parent_1, const int *parent_2, const int tour_length, int *child,
+	RandomGenerator &generator, CrossoverScratch &scratch)
+{
+	if (tour_length == 0) return;
+
+	for (int i = 0; i < tour_length; i++)
+	{
+		scratch.neighbor_count[parent_1[i]] = 0;
+	}
+	for (const int *parent : {parent_1, parent_2})
+	{
+		for (int i = 0; i < tour_length; i++)
+		{
+			const int next = parent[i + 1 == tour_length ? 0 : i + 1];
+			AddEdge(scratch, parent[i], next);
+			AddEdge(scratch, next, parent[i]);
+		}
+	}
+
+	scratch.unvisited.assign(parent_1, parent_1 + tour_length);
+	for (int i = 0; i < tour_length; i++)
+	{
+		scratch.unvisited_position[parent_1[i]] = i;
+	}
+
+	int current = HelperFunctions::RandomNumberGenerator(0, 1, generator) == 0 ? parent_1[0] : parent_2[0];
+	for (int child_index = 0; child_index < tour_length; child_index++)
+	{
+		child[child_index] = current;
+
+		//take the current customer out of the unvisited array and out of the edge table
+		const int last = scratch.unvisited.back();
+		scratch.unvisited[scratch.unvisited_position[current]] = last;
+		scratch.unvisited_position[last] = scratch.unvisited_position[current];
+		scratch.unvisited.pop_back();
+
+		const int *current_neighbors = &scratch.neighbors[static_cast<size_t>(current) * ERX_MAX_NEIGHBORS];
+		const int current_neighbor_count = scratch.neighbor_count[current];
+		for (int i = 0; i < current_neighbor_count; i++)
+		{
+			RemoveEdge(scratch, current_neighbors[i], current);
+		}
+		if (scratch.unvisited.empty()) break;
+
+		int next = -1;
+		int fewest_neighbors = ERX_MAX_NEIGHBORS + 1;
+		int ties = 0;
+		for (int i = 0; i < current_neighbor_count; i++)
+		{
+			const int candidate = current_neighbors[i];
+			const int candidate_neighbors = scratch.neighbor_count[candidate];
+			if (candidate_neighbors < fewest_neighbors)
+			{
+				next = candidate;
+				fewest_neighbors = candidate_neighbors;
+				ties = 1;
+			}
+			else if (candidate_neighbors == fewest_neighbors && HelperFunctions::RandomNumberGenerator(0, ties++, generator) == 0)
+			{
+				next = candidate;
+			}
+		}
+		if (next == -1)
+		{
+			next = scratch.unvisited[HelperFunctions::RandomNumberGenerator(0, static_cast<int>(scratch.unvisited.size()) - 1, generator)];
+		}
+		current = next;
+	}
+}
+
+const char *CrossoverOperators::GetName(const CrossoverOperator crossover)
+{
+	switch (crossover)
+	{
+	case SinglePointCrossover: return "Single Point";
+	case OrderCrossover: return "Order (OX)";
+	case PartiallyMappedCrossover: return "Partially Mapped (PMX)";
+	case EdgeRecombinationCrossover: return "Edge Recombination (ERX)";
+	}
+	return "Unknown";
+}
+
+/**
+* Forgets which genes were in the last child. The stamps only have to be cleared when the counter wraps around.
+*/
+void CrossoverOperators::BeginChild(CrossoverScratch &scratch)
+{
+	if (++scratch.stamp == 0)
+	{
+		fill(scratch.seen.begin(), scratch.seen.end(), 0u);
+		scratch.stamp = 1;
+	}
+}
+
+/**
+* Adds an edge to the ERX edge table, unless the customer already has it from the other parent.
+*/
+void CrossoverOperators::AddEdge(CrossoverScratch &scratch, const int node, const int neighbor)
+{
+	if (node == neighbor) return;
+	int *node_neighbors = &scratch.neighbors[static_cast<size_t>(node) * ERX_MAX_NEIGHBORS];
+	int &count = scratch.neighbor_count[node];
+	for (int i = 0; i < count; i++)
+	{
+		if (node_neighbors[i] == neighbor) return;
+	}
+	node_neighbors[count++] = neighbor;
+}
+
+/**
+* Removes an edge from the ERX edge table, by moving the last neighbor of the customer into its place.
+*/
+void CrossoverOperators::RemoveEdge(CrossoverScratch &scratch, const int node, const int neighbor)
+{
+	int *node_neighbors = &scratch.neighbors[static_cast<size_t>(node) * ERX_MAX_NEIGHBORS];
+	int &count = scratch.neighbor_count[node];
+	for (int i = 0; i < count; i++)
+	{
+		if (node_neighbors[i] == neighbor)
+		{
+			node_neighbors[i] = node_neighbors[--count];
+			return;
+		}
+	}
+}
+
+/**
+* Draws the slice of the first parent that OX and PMX copy into the child.
+*
+* @param tour_length The number of customers in the tours
+* @param generator The random number stream of the worker doing the crossover
+* @param slice_start Receives the first position of the slice
+* @param slice_end Receives the last position of the slice (inclusive)
+*/
+void CrossoverOperators::DrawSlice(const int tour_length, RandomGenerator &generator, int &slice_start, int &slice_end)
+{
+	slice_start = HelperFunctions::RandomNumberGenerator(0, tour_length - 1, generator);
+	slice_end = HelperFunctions::RandomNumberGenerator(0, tour_length - 1, generator);
+	if (slice_start > slice_end) swap(slice_start, slice_end);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+
+#include "../../RandomGenerator.h"
+
+using namespace std;
+
+constexpr int ERX_MAX_NEIGHBORS = 4; /*!< A node has at most two neighbors in each of the two parents */
+
+/**
+* The permutation crossovers the Genetic Algorithm can breed its children with, see CrossoverOperators.
+*/
+enum CrossoverOperator
+{
+	SinglePointCrossover, /*!< A prefix of the first parent, followed by the missing genes in the order of the second parent*/
+	OrderCrossover, /*!< OX: a slice of the first parent, with the missing genes filled in around it in the order of the second parent*/
+	PartiallyMappedCrossover, /*!< PMX: a slice of the first parent, everything else taken from the second parent at the same position where possible*/
+	EdgeRecombinationCrossover /*!< ERX: a tour built mostly from the edges the two parents have, preferring the nodes with the fewest edges left*/
+};
+
+/**
+* Bookkeeping for the crossovers, sized to the node indices of the problem.
+*
+* Whether a gene is already in the child is kept as a stamp per node instead of a flag,
+* so starting a new child is one increment rather than clearing the whole array.
+* The scratch is not thread safe, so every thread doing crossovers needs its own.
+*/
+struct CrossoverScratch
+{
+	explicit CrossoverScratch(const int node_count) :
+		seen(node_count, 0),
+		position(node_count, 0),
+		neighbors(static_cast<size_t>(node_count) * ERX_MAX_NEIGHBORS, 0),
+		neighbor_count(node_count, 0),
+		unvisited_position(node_count, 0)
+	{
+	}
+
+	vector<unsigned> seen; /*!< A node is in the current child if its entry equals #stamp*/
+	unsigned stamp = 0;
+	vector<int> position; /*!< Position of each node in the first parent (PMX)*/
+	vector<int> neighbors; /*!< Edge table, #ERX_MAX_NEIGHBORS entries per node (ERX)*/
+	vector<int> neighbor_count; /*!< Number of entries of each node in the edge table that are still unvisited (ERX)*/
+	vector<int> unvisited; /*!< The nodes not in the child yet, in no particular order (ERX)*/
+	vector<int> unvisited_position; /*!< Where each node is in #unvisited (ERX)*/
+};
+
+/***************************************************************************//**
+ * O(n) permutation crossovers for the Genetic Algorithm.
+ *
+ * Every operator takes two parent tours of the same customers and writes a child with
+ * every customer exactly once into a buffer of the same length. None of them search
+ * the child for a gene: membership is looked up in the CrossoverScratch, so each child
+ * costs time linear in the tour length and doesn't allocate anything.
+ ******************************************************************************/
+class CrossoverOperators
+{
+public:
+	static void Apply(CrossoverOperator crossover, const int *parent_1, const int *parent_2, int tour_length, int *child,
+		RandomGenerator &generator, CrossoverScratch &scratch);
+
+	static void SinglePoint(const int *parent_1, const int *parent_2, int tour_length, int *child, RandomGenerator &generator, CrossoverScratch &scratch);
+	static void Order(const int *parent_1, const int *parent_2, int tour_length, int *child, RandomGenerator &generator, CrossoverScratch &scratch);
+	static void PartiallyMapped(const int *parent_1, const int *parent_2, int tour_length, int *child, RandomGenerator &generator, CrossoverScratch &scratch);
+	static void EdgeRecombination(const int *parent_1, const int *parent_2, int tour_length, int *child, RandomGenerator &generator, CrossoverScratch &scratch);
+
+	static const char *GetName(CrossoverOperator crossover);
+
+private:
+	static void BeginChild(CrossoverScratch &scratch);
+	static void AddEdge(CrossoverScratch &scratch, int node, int neighbor);
+	static void RemoveEdge(CrossoverScratch &scratch, int node, int neighbor);
+	static void DrawSlice(int tour_length, RandomGenerator &generator, int &slice_start, int &slice_end);
+};
@@ -1,10 +1,11 @@
 #include "GeneticAlgorithmOptimizer.h"
 
 #include <cassert>
-#include <set>
-#include "../../Vehicle.h"
+#include <memory>
+#include "../../RouteEvaluator.h"
 #include "../../HelperFunctions.h"
 #include "../../SolutionSet.h"
+#include "../../ThreadPool.h"
 
 void GeneticAlgorithmOptimizer::SetSeedSolutions(const SolutionSet* seed)
 {
@@ -12,66 +13,163 @@ void GeneticAlgorithmOptimizer::SetSeedSolutions(const SolutionSet* seed)
 	has_seed_solutions = true;
 }
 
+/**
+* Chooses how the children are bred from their parents. Every crossover takes O(n) time per child, see CrossoverOperators.
+*
+* @param crossover The crossover to use instead of the default #SinglePointCrossover
+*/
+void GeneticAlgorithmOptimizer::SetCrossoverOperator(const CrossoverOperator crossover)
+{
+	crossover_operator = crossover;
+
+	vector<string> hyper_parameters;
+	hyper_parameters.push_back(string("Crossover: ") + CrossoverOperators::GetName(crossover_operator));
+	SetHyperParameters(hyper_parameters);
+}
+
+/**
+* Turns the GA into a memetic algorithm, where some of the children are improved by a few moves of the LocalSearch
+* after they have been bred and evaluated, so the population is pulled towards local optima.
+*
+* @param rate The chance that each child gets improved, 0 turns the memetic step off again
+* @param max_improvements The most local search moves made on each child that gets improved
+*/
+void GeneticAlgorithmOptimizer::SetLocalSearch(const float rate, const int max_improvements)
+{
+	local_search_rate = rate;
+	local_search_improvements = max(1, max_improvements);
+
+	vector<string> hyper_parameters;
+	hyper_parameters.push_back(string("Local Search Rate: ") + to_string(local_search_rate));
+	hyper_parameters.push_back(string("Local Search Moves: ") + to_string(local_search_improvements));
+	SetHyperParameters(hyper_parameters);
+}
+
+/**
+* Chooses which moves the memetic step tries, overriding the default for the instance size, see LocalSearch::SetGranular.
+*
+* @param use_neighbor_lists Whether only the moves that touch the neighbor lists are tried
+*/
+void GeneticAlgorithmOptimizer::SetGranularSearch(const bool use_neighbor_lists)
+{
+	local_search.SetGranular(use_neighbor_lists);
+	SetHyperParameters({string("Granular Search: ") + (use_neighbor_lists ? "Yes" : "No")});
+}
+
+/**
+* Switches Optimize over to the island model, see OptimizeIslands.
+*
+* @param islands The number of islands, each of which runs on its own thread. 1 or less runs the regular GA
+* @param interval The number of generations between migrations
+* @param topology Which islands send their best solutions to which
+*/
+void GeneticAlgorithmOptimizer::SetIslandModel(const int islands, const int interval, const MigrationTopology topology)
+{
+	island_count = max(1, islands);
+	migration_interval = max(1, interval);
+	migration_topology = topology;
+
+	vector<string> hyper_parameters;
+	hyper_parameters.push_back(string("Islands: ") + to_string(island_count));
+	hyper_parameters.push_back(string("Migration Interval: ") + to_string(migration_interval));
+	hyper_parameters.push_back(string("Migration Topology: ") + (migration_topology == RingTopology ? "Ring" : "Fully Connected"));
+	SetHyperParameters(hyper_parameters);
+}
+
 /**
 * Core of the Genetic Algorithm.
-* This function instanciates a Vehicle, that will simulate driving each of the routes, 
+* This function uses the RouteEvaluator, that will simulate driving each of the routes, 
 * as well as vectors that will hold the current generation and their fitnesses.
 * The function first creates a population of #POPULATION_SIZE by randomly generating valid 
 * tours through each of the customer nodes and calculates the fitness of each. Then the code 
-* iterates for #MAX_GENERATIONS iterations, performing Tournament Selection, Single Point Crossover,
+* iterates for #MAX_GENERATIONS iterations, performing Tournament Selection, Crossover (see SetCrossoverOperator),
 * and Mutation to generate a new population of #POPULATION_SIZE. Fitnesses of each of the children 
-* are calculated via the Vehicle class. At the end of the generations, the child with the lowest 
+* are calculated via the RouteEvaluator. At the end of the generations, the child with the lowest 
 * fitness is returned. The tour with the lowest distance at the end of #MAX_GENERATIONS should 
 * be the most optimal route through each of the customer nodes.
 * 
 * Each tour is represented by a vector of ints, where each int is the index of a customer node in 
 * the vector of all nodes. We only consider solutions that include 1 of each customer node as "valid"
 * due to the restrictions of the EVRP. Since there is no requirement to visit each of the charging stations
-* or the depot if we don't have to, solutions take the form of the order in which the Vehicle should visit
-* each customer node. The Vehicle class will take the proposed tour and calculate the true distance of that
+* or the depot if we don't have to, solutions take the form of the order in which the vehicle should visit
+* each customer node. The RouteEvaluator will take the proposed tour and calculate the true distance of that
 * route through simulation, stopping at a charging station or the depot whenever the proposed route demands it
 * (ran out of inventory or needs to recharge battery before getting stranded). 
 * 
-* The fitness of each solution is represented by the true distance of the route as simulated by the Vehicle class.
+* The fitness of each solution is represented by the true distance of the route as simulated by the RouteEvaluator.
 * We seek to minimize the true distance through a Genetic Algorithm approach. 
 * 
+* Creating and evaluating the children of a generation is split across a ThreadPool. Each worker has its own
+* EvaluationScratch, CrossoverScratch and LocalSearchScratch. Every child has a random number stream of its own, numbered by its
+* generation and slot, and child i is always written to slot i of the next generation, so a run is reproducible for a given
+* random seed no matter how many workers it runs on.
+* 
+* The current and next generation are two SolutionSets that swap places every generation, so the populations are
+* allocated once for the whole run instead of once per generation.
+* 
+* If SetIslandModel was called with more than one island, the island model in OptimizeIslands is run instead.
+* 
 * @param best_solution
 */
 void GeneticAlgorithmOptimizer::Optimize(solution &best_solution)
 {
-	//Vehicle class used to calculate the fitness of each route. Initialized with each Node, the vehicle's batter capacity, load capacity, and battery consumption rate
-	auto *current_generation = new SolutionSet();
+	SetHyperParameters({string("Random Seed: ") + to_string(random_seed)});
+	if (island_count > 1)
+	{
+		OptimizeIslands(best_solution);
+		return;
+	}
+
+	const int tour_length = static_cast<int>(problem_data->GetCustomerNodes().size());
+	SolutionSet current_generation;
+	SolutionSet next_generation;
+
+	//the pool lives for the whole run, so the worker threads are only started once
+	ThreadPool pool(worker_count);
+	const int workers = pool.GetWorkerCount();
+
+	//every worker gets its own scratch buffers, so the workers never share mutable state
+	vector<EvaluationScratch> worker_scratch;
+	vector<CrossoverScratch> worker_crossover_scratch;
+	vector<LocalSearchScratch> worker_search_scratch(workers);
+	worker_scratch.reserve(workers);
+	worker_crossover_scratch.reserve(workers);
+	for (int worker = 0; worker < workers; worker++)
+	{
+		worker_scratch.emplace_back(problem_data);
+		worker_crossover_scratch.emplace_back(problem_data->GetNodeCount());
+	}
 
-	int seed_solution_count = 0;
 	if(has_seed_solutions)
 	{
 		cout << "GA using seed solutions" << endl;
-		seed_solution_count = seed_solutions->GetNumberOfSolutions();
-		for(const auto &seed : seed_solutions->GetSolutionSet())
+		for(const int seed : seed_solutions->GetBestIndices(POPULATION_SIZE))
 		{
-			current_generation->AddSolutionToSet(seed);
-
-			if(current_generation->GetNumberOfSolutions() >= POPULATION_SIZE) break;
+			current_generation.AddSolutionToSet(seed_solutions->GetSolution(seed));
 		}
 	}
+	const int seed_solution_count = current_generation.GetNumberOfSolutions();
 	
-	//generate initial population and fitnesses
-	for (int i = 0; i < POPULATION_SIZE - seed_solution_count; i++)
+	//generate initial population and fitnesses. children are written into their own slot by whichever worker creates them
+	const int initial_solution_count = POPULATION_SIZE - seed_solution_count;
+	current_generation.Resize(POPULATION_SIZE, tour_length);
+	pool.ParallelFor(initial_solution_count, [&](const int worker, const int i)
 	{
-		//Generate initial solutions, then calculate the fitnesses using the Vehicle.SimulateDrive()
-		vector<Node> initial_tour = problem_data->GenerateRandomTour();
-		solution initial_solution = {initial_tour, vehicle->SimulateDrive(initial_tour)};
-
-		//Add the initial solutions and initial distances (fitness of solution) to respective vectors
-		current_generation->AddSolutionToSet(initial_solution);
-	}
+		//Generate initial solutions, then calculate the fitnesses using the RouteEvaluator
+		RandomGenerator generator(random_seed, static_cast<uint64_t>(i));
+		solution initial_solution(problem_data->GenerateRandomTour(generator));
+		auto trace = make_shared<RouteTrace>();
+		initial_solution.distance = evaluator.EvaluateIncremental(initial_solution.tour, nullptr, 0, worker_scratch[worker], *trace).distance;
+		initial_solution.trace = std::move(trace);
+		current_generation.SetSolution(seed_solution_count + i, initial_solution);
+	});
 
 	
-	assert(current_generation->GetNumberOfSolutions() == POPULATION_SIZE);
+	assert(current_generation.GetNumberOfSolutions() == POPULATION_SIZE);
 
 	
-	cout << "Average fitness for first generation: " << current_generation->GetAverageDistance() << endl;
-	cout << "Best fitness for first generation: " << current_generation->GetBestSolution().distance << endl;
+	cout << "Average fitness for first generation: " << current_generation.GetAverageDistance() << endl;
+	cout << "Best fitness for first generation: " << current_generation.GetMinimumDistance() << endl;
 	/*
 	if(has_seed_solutions)
 	{
@@ -84,6 +182,8 @@ void GeneticAlgorithmOptimizer::Optimize(solution &best_solution)
 	}
 	*/
 
+	RouteCacheStatistics previous_cache_statistics = {};
+	route_cache_hit_rates.clear();
 	//iterate for #MAX_GENERATIONS generations
 	for (int generation = 0; generation < MAX_GENERATIONS; generation++)
 	{
@@ -96,37 +196,30 @@ void GeneticAlgorithmOptimizer::Optimize(solution &best_solution)
 		//vector<vector<int>> newPopulation;
 		//vector<float> newDistances;
 
-		auto *next_generation = new SolutionSet();
-
-		for (int i = 0; i < POPULATION_SIZE; i++)
+		//child i goes into row i of the next generation, regardless of which worker finished first. The initial population used the first #POPULATION_SIZE streams
+		next_generation.Resize(POPULATION_SIZE, tour_length);
+		pool.ParallelFor(POPULATION_SIZE, [&](const int worker, const int i)
 		{
-			//select parents
-			//perform crossover between parents
-			//mutate child
-			//const vector<int> parentTour1 = TournamentSelection(population, tourDistances);
-			//const vector<int> parentTour2 = TournamentSelection(population, tourDistances);
-			const solution parent_solution_1 = TournamentSelection(current_generation);
-			const solution parent_solution_2 = TournamentSelection(current_generation);
-			
-			solution child = Crossover(parent_solution_1, parent_solution_2);
-			const int r = HelperFunctions::RandomNumberGenerator(0, 100);
-			if (r <= static_cast<int>(MUTATION_RATE * 100.f))
-			{
-				Mutate(child);
-			}
-
-			//add child to new population and calculate new fitness 
-			child.distance = vehicle->SimulateDrive(child.tour);
-
-			next_generation->AddSolutionToSet(child);
-		}
-		current_generation = next_generation;
+			RandomGenerator generator(random_seed, static_cast<uint64_t>(generation + 1) * POPULATION_SIZE + i);
+			next_generation.SetSolution(i, CreateChild(&current_generation, generator, worker_scratch[worker], worker_crossover_scratch[worker], worker_search_scratch[worker]));
+		});
+		swap(current_generation, next_generation);
 
-		assert(current_generation->GetNumberOfSolutions() == POPULATION_SIZE);
+		assert(current_generation.GetNumberOfSolutions() == POPULATION_SIZE);
 
 		
-		cout << "Average fitness for generation " << generation << ": " << current_generation->GetAverageDistance() << endl;
-		cout << "Best fitness for generation: " << generation << ": " << current_generation->GetBestSolution().distance << endl;
+		cout << "Average fitness for generation " << generation << ": " << current_generation.GetAverageDistance() << endl;
+		cout << "Best fitness for generation: " << generation << ": " << current_generation.GetMinimumDistance() << endl;
+		if (evaluator.GetRouteCache() != nullptr)
+		{
+			const RouteCacheStatistics cache_statistics = evaluator.GetRouteCache()->GetStatistics();
+			const long long hits = cache_statistics.hits - previous_cache_statistics.hits;
+			const long long lookups = hits + cache_statistics.misses - previous_cache_statistics.misses;
+			route_cache_hit_rates.push_back(lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0);
+			cout << "Route cache hit rate for generation " << generation << ": " << 100.0 * route_cache_hit_rates.back() << "% of " << lookups
+				<< " routes, " << cache_statistics.size << " cached, " << cache_statistics.evictions << " evicted" << endl;
+			previous_cache_statistics = cache_statistics;
+		}
 		/*
 		if(has_seed_solutions && generation % 25 == 0)
 		{
@@ -156,11 +249,192 @@ void GeneticAlgorithmOptimizer::Optimize(solution &best_solution)
 	}
 
 	//select the best tour after #MAX_GENERATIONS generations
-	best_solution = current_generation->GetBestSolution();
+	best_solution = current_generation.GetBestSolution();
 
 	//cout << "Best tour: ";
 	//HelperFunctions::PrintTour(bestTour);
-	//cout << "The best tour has distance breakdown: " << vehicle->SimulateDrive(bestTour, true) << endl;
+	//cout << "The best tour has distance breakdown: " << evaluator.Evaluate(bestTour, scratch, true).distance << endl;
+}
+
+/**
+* Island model version of the Genetic Algorithm.
+*
+* Instead of every thread running its own isolated copy of the GA, each of the #island_count islands evolves
+* its own population of #POPULATION_SIZE on its own thread, and every #migration_interval generations sends
+* copies of its #ISLAND_MIGRANT_COUNT best solutions to its neighbors. Incoming migrants take the place of
+* the last children bred in the receiving island's next generation. The neighbors of an island are decided
+* by the #migration_topology: the next island over in a ring, or every other island.
+*
+* Migration goes through one MigrationMailbox per directed pair of islands. A mailbox only ever has one
+* sender and one receiver, so an atomic flag is enough to hand solutions over without any locks. If the
+* receiver hasn't picked up the last batch yet, the sender drops the new one rather than waiting, so
+* no island ever blocks on a slower neighbor.
+*
+* @param best_solution The best solution found on any island
+*/
+void GeneticAlgorithmOptimizer::OptimizeIslands(solution &best_solution)
+{
+	cout << "GA running " << island_count << " islands" << endl;
+
+	vector<MigrationMailbox> mailboxes(static_cast<size_t>(island_count) * island_count);
+	vector<solution> island_best(island_count);
+
+	ThreadPool pool(island_count);
+	pool.ParallelFor(island_count, [&](int, const int island)
+	{
+		EvaluationScratch island_scratch(problem_data);
+		CrossoverScratch island_crossover_scratch(problem_data->GetNodeCount());
+		LocalSearchScratch island_search_scratch;
+		RandomGenerator generator(random_seed, island);
+
+		//seed solutions are dealt out to the islands round robin from best to worst, so each island starts from different ones
+		const int tour_length = static_cast<int>(problem_data->GetCustomerNodes().size());
+		SolutionSet current_generation;
+		SolutionSet next_generation;
+		if (has_seed_solutions)
+		{
+			const vector<int> seeds = seed_solutions->GetBestIndices(seed_solutions->GetNumberOfSolutions());
+			for (size_t seed_index = island; seed_index < seeds.size(); seed_index += island_count)
+			{
+				current_generation.AddSolutionToSet(seed_solutions->GetSolution(seeds[seed_index]));
+				if (current_generation.GetNumberOfSolutions() >= POPULATION_SIZE) break;
+			}
+		}
+		while (current_generation.GetNumberOfSolutions() < POPULATION_SIZE)
+		{
+			vector<int> initial_tour = problem_data->GenerateRandomTour(generator);
+			auto trace = make_shared<RouteTrace>();
+			solution initial_solution(std::move(initial_tour));
+			initial_solution.distance = evaluator.EvaluateIncremental(initial_solution.tour, nullptr, 0, island_scratch, *trace).distance;
+			initial_solution.trace = std::move(trace);
+			current_generation.AddSolutionToSet(initial_solution);
+		}
+
+		vector<solution> migrants;
+		for (int generation = 0; generation < MAX_GENERATIONS; generation++)
+		{
+			//pick up any migrants the neighbors have sent since the last generation
+			migrants.clear();
+			for (int sender = 0; sender < island_count; sender++)
+			{
+				if (sender == island || !IsNeighbor(sender, island)) continue;
+				mailboxes[sender * island_count + island].Receive(migrants);
+			}
+			const int migrant_count = min(static_cast<int>(migrants.size()), POPULATION_SIZE);
+
+			next_generation.Resize(POPULATION_SIZE, tour_length);
+			for (int i = 0; i < POPULATION_SIZE - migrant_count; i++)
+			{
+				next_generation.SetSolution(i, CreateChild(&current_generation, generator, island_scratch, island_crossover_scratch, island_search_scratch));
+			}
+			for (int i = 0; i < migrant_count; i++)
+			{
+				next_generation.SetSolution(POPULATION_SIZE - migrant_count + i, migrants[i]);
+			}
+			swap(current_generation, next_generation);
+
+			if ((generation + 1) % migration_interval == 0)
+			{
+				vector<solution> emigrants;
+				for (const int emigrant : current_generation.GetBestIndices(ISLAND_MIGRANT_COUNT))
+				{
+					emigrants.push_back(current_generation.GetSolution(emigrant));
+				}
+				for (int receiver = 0; receiver < island_count; receiver++)
+				{
+					if (receiver == island || !IsNeighbor(island, receiver)) continue;
+					mailboxes[island * island_count + receiver].Send(emigrants);
+				}
+
+				if (island == 0)
+				{
+					cout << "Island 0 best fitness at generation " << generation << ": " << current_generation.GetMinimumDistance() << endl;
+				}
+			}
+		}
+
+		island_best[island] = current_generation.GetBestSolution();
+	});
+
+	best_solution = island_best[0];
+	for (const auto &sol : island_best)
+	{
+		found_tours->AddSolutionToSet(sol);
+		if (sol.distance < best_solution.distance) best_solution = sol;
+	}
+	cout << "Best fitness across all islands: " << best_solution.distance << endl;
+}
+
+/**
+* Checks if an island sends its migrants to another island under the current #migration_topology.
+*
+* @param sender The island sending migrants
+* @param receiver The island that would receive them
+*
+* @return Whether or not the receiver is a neighbor of the sender
+*/
+bool GeneticAlgorithmOptimizer::IsNeighbor(const int sender, const int receiver) const
+{
+	switch (migration_topology)
+	{
+	case RingTopology:
+		return (sender + 1) % island_count == receiver;
+	case FullyConnectedTopology:
+		return sender != receiver;
+	}
+	return false;
+}
+
+/**
+* Creates a single child for the next generation by selecting two parents, crossing them over, maybe
+* mutating the result, and evaluating it. If the memetic step is on, the child may then be improved by the local search. Only the part of the child after the longest prefix it shares with
+* either parent is simulated, see RouteEvaluator::EvaluateIncremental.
+*
+* @param current_population The population to select the parents from
+* @param generator The random number stream of the thread creating the child
+* @param child_scratch The scratch buffers of the thread creating the child
+* @param crossover_scratch The crossover scratch of the thread creating the child
+* @param search_scratch The local search scratch of the thread creating the child
+*
+* @return The new child, with its distance already calculated
+*/
+solution GeneticAlgorithmOptimizer::CreateChild(const SolutionSet *current_population, RandomGenerator &generator, EvaluationScratch &child_scratch, CrossoverScratch &crossover_scratch,
+	LocalSearchScratch &search_scratch) const
+{
+	//select parents
+	//perform crossover between parents
+	//mutate child
+	//the parents are only ever read, so they stay in place in the population
+	const int tour_length = current_population->GetTourLength();
+	const int parent_1 = TournamentSelection(current_population, generator);
+	const int parent_2 = TournamentSelection(current_population, generator);
+	const int *parent_tour_1 = current_population->GetTour(parent_1);
+	const int *parent_tour_2 = current_population->GetTour(parent_2);
+	
+	solution child = Crossover(parent_tour_1, parent_tour_2, tour_length, generator, crossover_scratch);
+	const int r = HelperFunctions::RandomNumberGenerator(0, 100, generator);
+	if (r <= static_cast<int>(MUTATION_RATE * 100.f))
+	{
+		Mutate(child, generator);
+	}
+
+	//the child starts with the same genes as one of its parents, so the simulation picks up where that parent's left off
+	const int shared_prefix_1 = HelperFunctions::SharedPrefixLength(child.tour.data(), parent_tour_1, tour_length);
+	const int shared_prefix_2 = HelperFunctions::SharedPrefixLength(child.tour.data(), parent_tour_2, tour_length);
+	const RouteTrace *prefix_trace = current_population->GetTrace(shared_prefix_1 >= shared_prefix_2 ? parent_1 : parent_2);
+	const int shared_prefix = max(shared_prefix_1, shared_prefix_2);
+
+	//calculate the fitness of the child with the calling thread's scratch buffers
+	auto trace = make_shared<RouteTrace>();
+	child.distance = evaluator.EvaluateIncremental(child.tour, prefix_trace, shared_prefix, child_scratch, *trace).distance;
+	child.trace = std::move(trace);
+
+	//the random draw is skipped when the memetic step is off, so plain GA runs stay reproducible
+	if (local_search_rate > 0.f && HelperFunctions::RandomNumberGenerator(0, 99, generator) < static_cast<int>(local_search_rate * 100.f))
+	{
+		local_search.Improve(child, child_scratch, search_scratch, local_search_improvements);
+	}
+	return child;
 }
 
 /**
@@ -168,73 +442,55 @@ void GeneticAlgorithmOptimizer::Optimize(solution &best_solution)
 * 
 * Tournament selection selects the best parent out of #TOURNAMENT_SIZE possible parents
 * 
-* @param current_population The entire population, which consists of a vector of vectors of ints. We are selecting our candidate solution from the list of all solutions
+* Only the distances of the candidates are looked at, so the selection works on row indices into the population
+* and never copies a tour or allocates anything. The caller reads the winner's tour straight out of the population.
+* 
+* @param current_population The entire population. We are selecting our candidate solution from the list of all solutions
+* @param generator The random number stream of the worker doing the selection
 * 
-* @return Returns the best solution (lowest true distance) out of max(2, #TOURNAMENT_SIZE) solutions
+* @return Returns the index of the best solution (lowest true distance) out of max(2, #TOURNAMENT_SIZE) solutions. Ties go to the candidate drawn first
 */
-solution GeneticAlgorithmOptimizer::TournamentSelection(const SolutionSet *current_population) const
+int GeneticAlgorithmOptimizer::TournamentSelection(const SolutionSet *current_population, RandomGenerator &generator)
 {
-	auto *tournament_solutions = new SolutionSet();
-	
-	for (int i = 0; i < max(2, TOURNAMENT_SIZE); i++)
+	const int last_index = current_population->GetNumberOfSolutions() - 1;
+
+	int best_index = HelperFunctions::RandomNumberGenerator(0, last_index, generator);
+	float best_distance = current_population->GetDistance(best_index);
+	for (int i = 1; i < max(2, TOURNAMENT_SIZE); i++)
 	{
-		solution s = current_population->GetRandomSolution();
-		tournament_solutions->AddSolutionToSet(s);
+		const int candidate = HelperFunctions::RandomNumberGenerator(0, last_index, generator);
+		const float candidate_distance = current_population->GetDistance(candidate);
+		if (candidate_distance < best_distance)
+		{
+			best_index = candidate;
+			best_distance = candidate_distance;
+		}
 	}
-	return tournament_solutions->GetBestSolution();
+	return best_index;
 }
 
 
 /**
 * Critical element of the Genetic Algorithm.
 * 
-* Crossover performs Single Point Crossover, where a random number of 
-* elements are selected from the first parent, then the rest of the
-* elements are filled by unique elements of the second parent
+* Crossover breeds a child out of two parents with the #crossover_operator, Single Point Crossover by default, where
+* a random number of elements are selected from the first parent, then the rest of the elements are filled by
+* unique elements of the second parent. Whether an element is already in the child is looked up in the
+* CrossoverScratch instead of searched for, so every crossover takes O(n) time.
 * 
-* @param parent_1 The first parent solution we will perform crossover on
-* @param parent_2 The second parent solution for the crossover algorithm
+* @param parent_1 The tour of the first parent solution we will perform crossover on
+* @param parent_2 The tour of the second parent solution for the crossover algorithm
+* @param tour_length The number of customers in both tours
+* @param generator The random number stream of the worker doing the crossover
+* @param crossover_scratch The crossover scratch of the worker doing the crossover
 * 
-* @return A unique element crossover of parent1 and parent2. This vector should contain an unmodified subset of parent1, with the remaining indices filled with unique elements from parent2
+* @return A unique element crossover of parent1 and parent2
 */
-solution GeneticAlgorithmOptimizer::Crossover(const solution &parent_1, const solution &parent_2) const
+solution GeneticAlgorithmOptimizer::Crossover(const int *parent_1, const int *parent_2, const int tour_length, RandomGenerator &generator, CrossoverScratch &crossover_scratch) const
 {
 	// Create a child vector with the same size as the parents
-	//vector<int> child(parentTour1.size());
-	//solution child = {};
-	vector<Node> child_tour(parent_1.tour.size());
-	//child_tour.reserve(parent_1.tour.size());
-
-	// Copy a random subset of elements from parent1 to the child
-	//int crossoverPoint = rand() % parentTour1.size();
-	const int crossover_point = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(parent_1.tour.size()));
-	copy_n(parent_1.tour.begin(), crossover_point, child_tour.begin());
-
-	// Fill the remaining elements in the child with unique elements from parent2
-	int child_index = crossover_point;
-	for (const Node &element : parent_2.tour)
-	{
-		// Check if the element is already present in the child
-		if (find(child_tour.begin(), child_tour.end(), element) == child_tour.end())
-		{
-			child_tour[child_index] = element;
-			++child_index;
-		}
-	}
-	/*
-	//this is to assert that the child doesn't contain any duplicates (i.e. the crossover algorithm didn't preserve uniqueness of the elements)
-	set<int> unique_s(child.begin(), child.end());
-	vector<int> unique_v(unique_s.begin(), unique_s.end());
-	for (size_t i = 0; i < unique_v.size() - 1; i++)
-	{
-		if (unique_v[i] + 1 != unique_v[i + 1])
-		{
-			cout << "\n\n\nERROR IN CROSSOVER!!!!\n\n\n" << endl;
-			HelperFunctions::PrintTour(child);
-			HelperFunctions::PrintTour(unique_v);
-			cout << "\n\n\n======================\n\n\n" << endl;
-		}
-	}*/
+	vector<int> child_tour(tour_length);
+	CrossoverOperators::Apply(crossover_operator, parent_1, parent_2, tour_length, child_tour.data(), generator, crossover_scratch);
 
 	solution child = {child_tour};
 	return child;
@@ -246,10 +502,11 @@ solution GeneticAlgorithmOptimizer::Crossover(const solution &parent_1, const so
 * Mutate performs a single node swap.This mutation only happens with a #MUTATION_RATE percent chance per child
 * 
 * @param child The solution that needs to be mutated
+* @param generator The random number stream of the worker doing the mutation
 */
-void GeneticAlgorithmOptimizer::Mutate(solution &child)
+void GeneticAlgorithmOptimizer::Mutate(solution &child, RandomGenerator &generator) const
 {
-	const int index1 = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(child.tour.size()) - 1);
-	const int index2 = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(child.tour.size()) - 1);
+	const int index1 = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(child.tour.size()) - 1, generator);
+	const int index2 = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(child.tour.size()) - 1, generator);
 	swap(child.tour[index1], child.tour[index2]);
 }
@@ -1,17 +1,62 @@
 #pragma once
+#include <atomic>
+
 #include "../AlgorithmBase.h"
+#include "../../ThreadPool.h"
+#include "CrossoverOperators.h"
+#include "../LocalSearch/LocalSearch.h"
 class SolutionSet;
 
 constexpr int POPULATION_SIZE = 200; /*!< Size of the population, aka how many solutions should each successive generation have*/
 constexpr int MAX_GENERATIONS = 500; /*!< Number of generations the evolution will take place over.*/
 constexpr int TOURNAMENT_SIZE = 20; /*!< The number of candidate solutions chosen at random from the current population when doing tournament selection*/
 constexpr float MUTATION_RATE = 0.2f; /*!< The percent chance that each child will get mutated*/
+constexpr int GA_WORKER_THREADS = 0; /*!< Number of threads that create and evaluate children in parallel. 0 uses every hardware thread*/
+constexpr int ISLAND_MIGRATION_INTERVAL = 25; /*!< Default number of generations between migrations in the island model*/
+constexpr int MEMETIC_MAX_IMPROVEMENTS = 10; /*!< Default number of local search moves made on a child picked for the memetic step*/
+constexpr float MEMETIC_RATE = 0.1f; /*!< Chance that a child is picked for the memetic step when EVRP_Solver::SolveEVRP_Memetic runs the GA*/
+constexpr int ISLAND_MIGRANT_COUNT = 2; /*!< Number of best solutions each island sends to each of its neighbors when migrating*/
+
+/**
+* Which islands send their migrants to which in the island model.
+*/
+enum MigrationTopology
+{
+	RingTopology, /*!< Island i sends to island i + 1, and the last island sends to the first*/
+	FullyConnectedTopology /*!< Every island sends to every other island*/
+};
+
+/**
+* Lock-free hand-over of migrants from one island to another. Each mailbox has exactly one sending
+* and one receiving thread, so the full flag is the only synchronization needed: the sender only
+* writes the migrants while it is clear, and the receiver only reads them while it is set.
+*/
+struct MigrationMailbox
+{
+	atomic<bool> full{false};
+	vector<solution> migrants;
+
+	void Send(const vector<solution> &outgoing)
+	{
+		//the receiver hasn't picked up the last batch yet, so this one is dropped instead of waiting
+		if (full.load(memory_order_acquire)) return;
+		migrants = outgoing;
+		full.store(true, memory_order_release);
+	}
+
+	void Receive(vector<solution> &incoming)
+	{
+		if (!full.load(memory_order_acquire)) return;
+		incoming.insert(incoming.end(), migrants.begin(), migrants.end());
+		full.store(false, memory_order_release);
+	}
+};
 
 class GeneticAlgorithmOptimizer : public AlgorithmBase
 {
 public:
 	GeneticAlgorithmOptimizer(const ProblemDefinition *data) :
-		AlgorithmBase("Genetic Algorithm", data)
+		AlgorithmBase("Genetic Algorithm", data), local_search(evaluator)
 	{
 		vector<string> hyper_parameters;
         
@@ -24,16 +69,42 @@ public:
 	}
 
 	void SetSeedSolutions(const SolutionSet* seed);
+	void SetWorkerCount(const int workers) override { worker_count = workers; }
+	int GetWorkerCount() const override { return island_count > 1 ? island_count : worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount(); }
+	void SetRandomSeed(const uint64_t seed) { random_seed = seed; }
+	void SetCrossoverOperator(CrossoverOperator crossover);
+	void SetLocalSearch(float rate, int max_improvements = MEMETIC_MAX_IMPROVEMENTS);
+	void SetGranularSearch(bool use_neighbor_lists);
+	void SetIslandModel(int islands, int interval = ISLAND_MIGRATION_INTERVAL, MigrationTopology topology = RingTopology);
 	void Optimize(solution &best_solution) override;
 
+	static int TournamentSelection(const SolutionSet *current_population, RandomGenerator &generator);
+	/** The hit rate of the route cache in every generation of the last Optimize, empty without EnableRouteCache or with the island model */
+	const vector<double> &GetRouteCacheHitRates() const { return route_cache_hit_rates; }
+
 private:
-	solution TournamentSelection(const SolutionSet *current_population) const;
-	solution Crossover(const solution &parent_1, const solution &parent_2) const;
-	void Mutate(solution &child);
+	void OptimizeIslands(solution &best_solution);
+	bool IsNeighbor(int sender, int receiver) const;
+	solution CreateChild(const SolutionSet *current_population, RandomGenerator &generator, EvaluationScratch &child_scratch, CrossoverScratch &crossover_scratch,
+		LocalSearchScratch &search_scratch) const;
+	solution Crossover(const int *parent_1, const int *parent_2, int tour_length, RandomGenerator &generator, CrossoverScratch &crossover_scratch) const;
+	void Mutate(solution &child, RandomGenerator &generator) const;
 
 	SolutionSet* seed_solutions;
 	bool has_seed_solutions = false;
 
+	int worker_count = GA_WORKER_THREADS; /*!< Number of workers in the thread pool, see #GA_WORKER_THREADS*/
+	CrossoverOperator crossover_operator = SinglePointCrossover; /*!< How the children are bred from their parents, see CrossoverOperators*/
+	LocalSearch local_search;
+	float local_search_rate = 0.f; /*!< The chance that each child gets improved by the #local_search, 0 turns the memetic step off*/
+	int local_search_improvements = MEMETIC_MAX_IMPROVEMENTS; /*!< The most local search moves made on each child that gets improved*/
+	vector<double> route_cache_hit_rates; /*!< See GetRouteCacheHitRates*/
+	uint64_t random_seed = RandomGenerator::GetRunSeed(); /*!< Seeds the random number stream of every child, the run seed unless SetRandomSeed is called. Runs with the same seed are reproducible on any number of workers*/
+
+	int island_count = 1; /*!< Number of islands in the island model, 1 runs the regular GA*/
+	int migration_interval = ISLAND_MIGRATION_INTERVAL; /*!< Number of generations between migrations*/
+	MigrationTopology migration_topology = RingTopology;
+
 	/*
 	float CalculateAverageSolution(vector<float> distances) const
 	{
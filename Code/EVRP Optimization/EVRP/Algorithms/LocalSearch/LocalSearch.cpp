@@ -0,0 +1,483 @@
+#include "LocalSearch.h"
+
+#include <algorithm>
+#include <memory>
+
+/**
+* Improves a solution until no move in any of the neighborhoods shortens it anymore, or until max_improvements
+* moves have been made. The neighborhoods are tried in the order 2-opt, Or-opt, relocate and swap, and the first move that
+* improves the tour is made right away, after which the search starts over with 2-opt.
+*
+* @param sol The solution to improve. Its distance has to be exact, and if it has a trace, the trace has to belong to its tour
+* @param scratch The evaluation scratch of the calling thread
+* @param search_scratch The local search scratch of the calling thread
+* @param max_improvements The most moves to make, so the search can be used as a cheap improvement step in other algorithms
+*
+* @return The number of moves that were made. The solution's tour, distance and trace are updated in place
+*/
+int LocalSearch::Improve(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch, const int max_improvements) const
+{
+	if (sol.tour.size() < 2) return 0;
+
+	//the screening needs the state of the vehicle along the current tour
+	if (sol.trace == nullptr)
+	{
+		auto trace = make_shared<RouteTrace>();
+		sol.distance = evaluator.EvaluateIncremental(sol.tour, nullptr, 0, scratch, *trace).distance;
+		sol.trace = std::move(trace);
+	}
+	UpdateAggregates(sol, search_scratch);
+
+	int improvements = 0;
+	while (improvements < max_improvements)
+	{
+		const bool improved = TryTwoOpt(sol, scratch, search_scratch)
+			|| TrySegmentMoves(sol, 2, OR_OPT_MAX_SEGMENT, scratch, search_scratch)
+			|| TrySegmentMoves(sol, 1, 1, scratch, search_scratch)
+			|| TrySwap(sol, scratch, search_scratch);
+		if (!improved) break;
+
+		improvements++;
+		UpdateAggregates(sol, search_scratch);
+	}
+	return improvements;
+}
+
+/**
+* 2-opt: reverses the customers from position i to position j, which replaces the arc into position i by an arc from
+* the node before it to the customer at position j. The granular search only tries the j whose customer is in the
+* neighbor list of the node before position i.
+*/
+bool LocalSearch::TryTwoOpt(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int tour_length = static_cast<int>(tour.size());
+	const int neighbor_count = problem_definition.GetNeighborCount();
+	for (int i = 0; i < tour_length - 1; i++)
+	{
+		if (granular)
+		{
+			const int *neighbors = problem_definition.GetNeighbors(NodeAt(tour, i - 1));
+			for (int n = 0; n < neighbor_count; n++)
+			{
+				const int j = search_scratch.position[neighbors[n]];
+				if (j > i && TryTwoOptMove(sol, i, j, scratch, search_scratch)) return true;
+			}
+		}
+		else
+		{
+			for (int j = i + 1; j < tour_length; j++)
+			{
+				if (TryTwoOptMove(sol, i, j, scratch, search_scratch)) return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+* Or-opt and relocate: moves the run of customers starting at position i somewhere else in the tour, in the same order.
+* The run is taken out from between its neighbors and put back in just before the customer at position k of the current tour.
+* The granular search only puts the run right after a neighbor of its first customer, or right before a neighbor of its last.
+*
+* @param sol The solution to improve
+* @param min_length The shortest run of customers to move
+* @param max_length The longest run of customers to move
+* @param scratch The evaluation scratch of the calling thread
+* @param search_scratch The local search scratch of the calling thread
+*
+* @return Whether an improving move was made
+*/
+bool LocalSearch::TrySegmentMoves(solution &sol, const int min_length, const int max_length, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int tour_length = static_cast<int>(tour.size());
+	const int neighbor_count = problem_definition.GetNeighborCount();
+	for (int length = min_length; length <= max_length; length++)
+	{
+		for (int i = 0; i + length <= tour_length; i++)
+		{
+			if (granular)
+			{
+				const int *first_neighbors = problem_definition.GetNeighbors(tour[i]);
+				const int *last_neighbors = problem_definition.GetNeighbors(tour[i + length - 1]);
+				for (int n = 0; n < neighbor_count; n++)
+				{
+					if (TrySegmentMove(sol, i, length, search_scratch.position[first_neighbors[n]] + 1, scratch, search_scratch)) return true;
+					if (TrySegmentMove(sol, i, length, search_scratch.position[last_neighbors[n]], scratch, search_scratch)) return true;
+				}
+			}
+			else
+			{
+				for (int k = 0; k <= tour_length; k++)
+				{
+					if (TrySegmentMove(sol, i, length, k, scratch, search_scratch)) return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+* Swap: exchanges the customers at positions i and j. The granular search only tries the j whose customer is in the
+* neighbor list of the node before position i, so that the swap puts it right after that node.
+*/
+bool LocalSearch::TrySwap(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int tour_length = static_cast<int>(tour.size());
+	const int neighbor_count = problem_definition.GetNeighborCount();
+	for (int i = 0; i < tour_length - 1; i++)
+	{
+		if (granular)
+		{
+			const int *neighbors = problem_definition.GetNeighbors(NodeAt(tour, i - 1));
+			for (int n = 0; n < neighbor_count; n++)
+			{
+				const int j = search_scratch.position[neighbors[n]];
+				if (j != i && TrySwapMove(sol, min(i, j), max(i, j), scratch, search_scratch)) return true;
+			}
+		}
+		else
+		{
+			for (int j = i + 1; j < tour_length; j++)
+			{
+				if (TrySwapMove(sol, i, j, scratch, search_scratch)) return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+* Screens and, if it passes, simulates the 2-opt move that reverses positions i to j. Distances are symmetric,
+* so only the two arcs at the ends of the reversed run change.
+*
+* @return Whether the move was made
+*/
+bool LocalSearch::TryTwoOptMove(solution &sol, const int i, const int j, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int before = NodeAt(tour, i - 1);
+	const int after = NodeAt(tour, j + 1);
+	const float delta = problem_definition.Distance(before, tour[j]) + problem_definition.Distance(tour[i], after)
+		- problem_definition.Distance(before, tour[i]) - problem_definition.Distance(tour[j], after);
+	if (!PassesScreening(sol, search_scratch, i, delta)) return false;
+
+	search_scratch.candidate_tour.assign(tour.begin(), tour.end());
+	reverse(search_scratch.candidate_tour.begin() + i, search_scratch.candidate_tour.begin() + j + 1);
+	return ConfirmMove(sol, i, j, delta, scratch, search_scratch);
+}
+
+/**
+* Screens and, if it passes, simulates moving the run of length customers at position i to just before position k.
+*
+* @return Whether the move was made
+*/
+bool LocalSearch::TrySegmentMove(solution &sol, const int i, const int length, const int k, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	//putting the run back before itself or before the customer right after it changes nothing
+	if (k >= i && k <= i + length) return false;
+
+	const vector<int> &tour = sol.tour;
+	const int first = tour[i];
+	const int last = tour[i + length - 1];
+	const int before = NodeAt(tour, i - 1);
+	const int after = NodeAt(tour, i + length);
+	const int insert_before = NodeAt(tour, k - 1);
+	const int insert_after = NodeAt(tour, k);
+	const float delta = problem_definition.Distance(insert_before, first) + problem_definition.Distance(last, insert_after)
+		- problem_definition.Distance(insert_before, insert_after)
+		- problem_definition.Distance(before, first) - problem_definition.Distance(last, after) + problem_definition.Distance(before, after);
+	const int first_changed = min(i, k);
+	if (!PassesScreening(sol, search_scratch, first_changed, delta)) return false;
+
+	vector<int> &candidate = search_scratch.candidate_tour;
+	candidate.assign(tour.begin(), tour.end());
+	if (k < i) rotate(candidate.begin() + k, candidate.begin() + i, candidate.begin() + i + length);
+	else rotate(candidate.begin() + i, candidate.begin() + i + length, candidate.begin() + k);
+	return ConfirmMove(sol, first_changed, k < i ? i + length - 1 : k - 1, delta, scratch, search_scratch);
+}
+
+/**
+* Screens and, if it passes, simulates exchanging the customers at positions i < j. Neighboring customers share an arc,
+* so they are handled separately.
+*
+* @return Whether the move was made
+*/
+bool LocalSearch::TrySwapMove(solution &sol, const int i, const int j, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int before_i = NodeAt(tour, i - 1);
+	const int after_i = NodeAt(tour, i + 1);
+	const int before_j = NodeAt(tour, j - 1);
+	const int after_j = NodeAt(tour, j + 1);
+	float delta;
+	if (j == i + 1)
+	{
+		delta = problem_definition.Distance(before_i, tour[j]) + problem_definition.Distance(tour[j], tour[i]) + problem_definition.Distance(tour[i], after_j)
+			- problem_definition.Distance(before_i, tour[i]) - problem_definition.Distance(tour[i], tour[j]) - problem_definition.Distance(tour[j], after_j);
+	}
+	else
+	{
+		delta = problem_definition.Distance(before_i, tour[j]) + problem_definition.Distance(tour[j], after_i)
+			+ problem_definition.Distance(before_j, tour[i]) + problem_definition.Distance(tour[i], after_j)
+			- problem_definition.Distance(before_i, tour[i]) - problem_definition.Distance(tour[i], after_i)
+			- problem_definition.Distance(before_j, tour[j]) - problem_definition.Distance(tour[j], after_j);
+	}
+	if (!PassesScreening(sol, search_scratch, i, delta)) return false;
+
+	search_scratch.candidate_tour.assign(tour.begin(), tour.end());
+	swap(search_scratch.candidate_tour[i], search_scratch.candidate_tour[j]);
+	return ConfirmMove(sol, i, j, delta, scratch, search_scratch);
+}
+
+/**
+* The O(1) screening of a move, see LocalSearch.
+*
+* @param sol The current solution
+* @param search_scratch Holds the aggregates of the current tour
+* @param first_changed The first position in the tour that the move changes
+* @param delta The change in straight-line distance of the customer sequence the move makes
+*
+* @return Whether the move could be an improvement and needs to be simulated
+*/
+bool LocalSearch::PassesScreening(const solution &sol, LocalSearchScratch &search_scratch, const int first_changed, const float delta) const
+{
+	search_scratch.screened_moves++;
+	if (delta > -LOCAL_SEARCH_EPSILON) return false;
+
+	//the optimal split and charging don't record checkpoints, so the bound has to start from the depot
+	const vector<float> &prefix_distance = search_scratch.prefix_distance;
+	const vector<RouteCheckpoint> &checkpoints = sol.trace->checkpoints;
+	if (checkpoints.empty()) return prefix_distance.back() + delta < sol.distance - LOCAL_SEARCH_EPSILON;
+
+	//an infeasible tour only has checkpoints up to the customer it got stuck at, and a move after that can't get it unstuck
+	if (first_changed >= static_cast<int>(checkpoints.size())) return false;
+
+	const float remaining_distance = prefix_distance.back() + delta - prefix_distance[first_changed];
+	return checkpoints[first_changed].distance + remaining_distance < sol.distance - LOCAL_SEARCH_EPSILON;
+}
+
+/**
+* Screens the load and battery of the suffix of search_scratch.candidate_tour from the checkpoint at the first changed
+* customer, see LocalSearch. Takes O(m) time for the m positions up to where the depot returns match the current tour's
+* again, and O(c) more for each arc of a stretch that needs charging, for c charging stations.
+*
+* @param sol The current solution
+* @param search_scratch Holds the aggregates of the current tour and the candidate tour
+* @param first_changed The first position in the tour that the move changes
+* @param last_changed The last position in the tour that the move changes
+* @param delta The change in straight-line distance of the customer sequence the move makes
+*
+* @return Whether the move could still be an improvement and needs to be simulated
+*/
+bool LocalSearch::PassesSuffixScreening(const solution &sol, LocalSearchScratch &search_scratch, const int first_changed, const int last_changed, const float delta) const
+{
+	//without checkpoints the depot returns aren't greedy, so there is nothing to replay
+	const vector<RouteCheckpoint> &checkpoints = sol.trace->checkpoints;
+	if (checkpoints.empty()) return true;
+
+	const vector<int> &candidate = search_scratch.candidate_tour;
+	const int tour_length = static_cast<int>(candidate.size());
+	const VehicleParameters &vehicle = problem_definition.GetVehicleParameters();
+	const int depot = problem_definition.GetDepotNode().index;
+	const float cutoff = sol.distance - LOCAL_SEARCH_EPSILON;
+	float bound = checkpoints[first_changed].distance + search_scratch.prefix_distance.back() + delta - search_scratch.prefix_distance[first_changed];
+
+	int inventory = search_scratch.inventory[first_changed];
+	float battery = checkpoints[first_changed].battery;
+	int previous = NodeAt(candidate, first_changed - 1);
+
+	//the stretch the vehicle drives on the battery it has, from stretch_from through the positions from stretch_begin on
+	int stretch_from = previous;
+	int stretch_begin = first_changed;
+	float stretch_distance = 0.f;
+
+	int p = first_changed;
+	for (; p <= tour_length; p++)
+	{
+		//from here on the arcs and the load are the same as the current tour's, so are its depot returns
+		if (p > last_changed + 1 && inventory == search_scratch.inventory[p])
+		{
+			bound += search_scratch.suffix_return_detour[p];
+			break;
+		}
+
+		const int node = NodeAt(candidate, p);
+		const int demand = problem_definition.GetNodeFromIndex(node).demand;
+		if (demand > inventory)
+		{
+			bound += DepotReturnDetour(previous, node);
+			stretch_distance += problem_definition.Distance(previous, depot);
+			if (stretch_distance * vehicle.battery_consumption_rate > battery + LOCAL_SEARCH_EPSILON)
+			{
+				bound += StretchChargingDetour(search_scratch, stretch_from, stretch_begin, p, depot);
+			}
+			previous = depot;
+			stretch_from = depot;
+			stretch_begin = p;
+			stretch_distance = 0.f;
+			battery = vehicle.battery_capacity;
+			inventory = vehicle.load_capacity;
+		}
+		stretch_distance += problem_definition.Distance(previous, node);
+		inventory -= demand;
+		previous = node;
+		if (bound >= cutoff) break;
+	}
+
+	//the last stretch either ended at the depot, or is only the part of it up to where the replay stopped
+	if (bound < cutoff && stretch_distance * vehicle.battery_consumption_rate > battery + LOCAL_SEARCH_EPSILON)
+	{
+		bound += p > tour_length ? StretchChargingDetour(search_scratch, stretch_from, stretch_begin, tour_length, depot)
+			: StretchChargingDetour(search_scratch, stretch_from, stretch_begin, p, -1);
+	}
+	if (bound < cutoff) return true;
+
+	search_scratch.suffix_screened_moves++;
+	return false;
+}
+
+/**
+* The detour a depot return makes between two consecutive customers, on top of the straight-line arc between them.
+* Whatever charging stops the vehicle makes on the way to and from the depot can only add to it.
+*/
+float LocalSearch::DepotReturnDetour(const int from, const int to) const
+{
+	const int depot = problem_definition.GetDepotNode().index;
+	return problem_definition.Distance(from, depot) + problem_definition.Distance(depot, to) - problem_definition.Distance(from, to);
+}
+
+/**
+* The least a stop at a charging station adds to the straight-line arc between two nodes. A path with several stops is
+* at least as long as going through its first one straight to the end, so this bounds any number of stops on the arc.
+* A station at the depot doesn't help on an arc from or to the depot, where the vehicle is either full or done.
+* Takes O(c) time for c charging stations.
+*/
+float LocalSearch::ChargingDetour(const int from, const int to) const
+{
+	const int depot = problem_definition.GetDepotNode().index;
+	const bool depot_arc = from == depot || to == depot;
+	const float direct = problem_definition.Distance(from, to);
+	float detour = numeric_limits<float>::max();
+	for (const auto &charger : problem_definition.GetChargingNodes())
+	{
+		if (depot_arc && problem_definition.Distance(charger.index, depot) == 0.f) continue;
+		detour = min(detour, problem_definition.Distance(from, charger.index) + problem_definition.Distance(charger.index, to) - direct);
+	}
+	return max(detour, 0.f);
+}
+
+/**
+* ChargingDetour for an arc of the candidate tour, looked up in the aggregates if the current tour has the same arc in either
+* direction, which all but the few arcs a move adds do.
+*/
+float LocalSearch::ArcChargingDetour(const LocalSearchScratch &search_scratch, const int from, const int to) const
+{
+	const int depot = problem_definition.GetDepotNode().index;
+	const int last = static_cast<int>(search_scratch.arc_charging_detour.size()) - 1;
+	const int from_position = from == depot ? -1 : search_scratch.position[from];
+	const int to_position = to == depot ? last : search_scratch.position[to];
+	if (to_position == from_position + 1) return search_scratch.arc_charging_detour[to_position];
+	if (from != depot && to != depot && from_position == to_position + 1) return search_scratch.arc_charging_detour[from_position];
+	if (from == depot && to != depot && to_position == 0) return search_scratch.arc_charging_detour[0];
+	if (to == depot && from != depot && from_position == last - 1) return search_scratch.arc_charging_detour[last];
+	return ChargingDetour(from, to);
+}
+
+/**
+* The least a charging stop adds to a stretch of the candidate tour, from a node through the positions [begin, end) on to another node.
+*
+* @param search_scratch Holds the candidate tour
+* @param from The node the stretch starts at
+* @param begin The first position of the stretch
+* @param end One past the last position of the stretch
+* @param to The node the stretch ends at after the last position, or -1 if it ends at the last position
+*/
+float LocalSearch::StretchChargingDetour(const LocalSearchScratch &search_scratch, const int from, const int begin, const int end, const int to) const
+{
+	const vector<int> &candidate = search_scratch.candidate_tour;
+	float detour = numeric_limits<float>::max();
+	int previous = from;
+	for (int p = begin; p < end; p++)
+	{
+		detour = min(detour, ArcChargingDetour(search_scratch, previous, candidate[p]));
+		previous = candidate[p];
+	}
+	if (to >= 0) detour = min(detour, ArcChargingDetour(search_scratch, previous, to));
+	return detour == numeric_limits<float>::max() ? 0.f : detour;
+}
+
+/**
+* Screens the suffix of the tour in search_scratch.candidate_tour, and if it passes, simulates it from the checkpoint
+* at the first changed customer and replaces the solution with it if it really is shorter.
+*
+* @return Whether the move was made
+*/
+bool LocalSearch::ConfirmMove(solution &sol, const int first_changed, const int last_changed, const float delta, EvaluationScratch &scratch,
+	LocalSearchScratch &search_scratch) const
+{
+	if (!PassesSuffixScreening(sol, search_scratch, first_changed, last_changed, delta)) return false;
+
+	search_scratch.simulated_moves++;
+	const float cutoff = sol.distance - LOCAL_SEARCH_EPSILON;
+	const EvaluationResult result = evaluator.EvaluateIncremental(search_scratch.candidate_tour, sol.trace.get(), first_changed, scratch,
+		search_scratch.candidate_trace, cutoff);
+	if (result.dominated || result.distance >= cutoff) return false;
+
+	search_scratch.improving_moves++;
+	sol.tour.swap(search_scratch.candidate_tour);
+	sol.distance = result.distance;
+	sol.trace = make_shared<RouteTrace>(std::move(search_scratch.candidate_trace));
+	return true;
+}
+
+/**
+* Recomputes the straight-line prefix distances, the load and detour aggregates and the customer positions of the current tour,
+* after it has changed. The distance, load and battery prefixes come from the solution's trace, which the evaluator keeps up to date,
+* but the inventory is replayed here too, since a trace of an infeasible tour stops early. Takes O(n c) time for n customers and
+* c charging stations.
+*/
+void LocalSearch::UpdateAggregates(const solution &sol, LocalSearchScratch &search_scratch) const
+{
+	const vector<int> &tour = sol.tour;
+	const int tour_length = static_cast<int>(tour.size());
+	vector<float> &prefix_distance = search_scratch.prefix_distance;
+	prefix_distance.resize(tour_length + 2);
+	search_scratch.position.resize(problem_definition.GetNodeCount());
+	for (int p = 0; p < tour_length; p++)
+	{
+		search_scratch.position[tour[p]] = p;
+	}
+
+	prefix_distance[0] = 0.f;
+	for (int p = 1; p <= tour_length + 1; p++)
+	{
+		prefix_distance[p] = prefix_distance[p - 1] + problem_definition.Distance(NodeAt(tour, p - 2), NodeAt(tour, p - 1));
+	}
+
+	//the arc into position p comes from the node before it, and the arc into the position after the tour is the return to the depot
+	const int load_capacity = problem_definition.GetVehicleParameters().load_capacity;
+	vector<int> &inventory = search_scratch.inventory;
+	vector<float> &suffix_return_detour = search_scratch.suffix_return_detour;
+	inventory.resize(tour_length + 1);
+	suffix_return_detour.resize(tour_length + 1);
+	search_scratch.arc_charging_detour.resize(tour_length + 1);
+	int load = load_capacity;
+	for (int p = 0; p <= tour_length; p++)
+	{
+		inventory[p] = load;
+		const int demand = problem_definition.GetNodeFromIndex(NodeAt(tour, p)).demand;
+		if (demand > load) load = load_capacity;
+		load -= demand;
+		search_scratch.arc_charging_detour[p] = ChargingDetour(NodeAt(tour, p - 1), NodeAt(tour, p));
+	}
+	suffix_return_detour[tour_length] = 0.f;
+	for (int p = tour_length - 1; p >= 0; p--)
+	{
+		const bool returns = problem_definition.GetNodeFromIndex(tour[p]).demand > inventory[p];
+		suffix_return_detour[p] = suffix_return_detour[p + 1] + (returns ? DepotReturnDetour(NodeAt(tour, p - 1), tour[p]) : 0.f);
+	}
+}
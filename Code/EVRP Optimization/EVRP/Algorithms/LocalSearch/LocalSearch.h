@@ -0,0 +1,108 @@
+#pragma once
+#include <limits>
+
+#include "../../RouteEvaluator.h"
+#include "../../SolutionSet.h"
+
+constexpr int OR_OPT_MAX_SEGMENT = 3; /*!< Longest run of consecutive customers an Or-opt move relocates. Relocate is the same move with a single customer*/
+constexpr int GRANULAR_SEARCH_MIN_CUSTOMERS = 200; /*!< Instances with at least this many customers only try moves that touch the neighbor lists by default, see LocalSearch::SetGranular*/
+constexpr float LOCAL_SEARCH_EPSILON = 0.001f; /*!< A move has to shorten the tour by more than this to count as an improvement*/
+
+/**
+* The buffers a LocalSearch writes to while improving a tour. Like EvaluationScratch, every thread running
+* a local search needs its own, and the buffers are reused so a warm scratch doesn't allocate.
+*/
+struct LocalSearchScratch
+{
+	vector<int> position; /*!< The position of every customer in the current tour, indexed by node index*/
+	vector<float> prefix_distance; /*!< prefix_distance[p] is the straight-line distance from the depot through the first p customers, with the return to the depot as the last entry*/
+	vector<int> inventory; /*!< inventory[p] is the load left before the vehicle heads to position p, with the greedy depot returns*/
+	vector<float> suffix_return_detour; /*!< suffix_return_detour[p] is what the depot returns before positions p and later add to the straight-line arcs they replace*/
+	vector<float> arc_charging_detour; /*!< arc_charging_detour[p] is the least a charging stop adds to the arc into position p, see LocalSearch::ChargingDetour*/
+	vector<int> candidate_tour; /*!< The tour with the move being confirmed applied to it*/
+	RouteTrace candidate_trace; /*!< The trace of #candidate_tour, which becomes the solution's trace if the move is kept*/
+
+	long long screened_moves = 0; /*!< Moves whose cost was estimated from the aggregates*/
+	long long suffix_screened_moves = 0; /*!< Moves that passed the screening, but not once the depot returns and charging stops of the new suffix were added*/
+	long long simulated_moves = 0; /*!< Moves that passed the screening and were simulated*/
+	long long improving_moves = 0; /*!< Moves that were kept*/
+};
+
+/***************************************************************************//**
+ * First-improvement local search over the 2-opt, Or-opt, relocate and swap neighborhoods.
+ *
+ * The true distance of a tour depends on where the RouteEvaluator decides to return to
+ * the depot and to detour to chargers, so it can't be updated exactly in O(1) for a move.
+ * Instead every move is screened in O(1) from aggregates of the current tour first:
+ *
+ * - the change in straight-line distance of the customer sequence, from the few arcs the move
+ *   replaces, which has to be negative for the move to be worth simulating, and
+ * - a lower bound on the true distance after the move, which is the distance, load and battery
+ *   state recorded in the solution's RouteTrace at the first customer the move changes, plus the
+ *   straight-line distance of the rest of the new customer sequence from prefix_distance.
+ *   Depot returns and charging detours can only add to that, so if the bound isn't below the
+ *   current distance, the move can't be an improvement.
+ *
+ * Moves that pass both screens are screened once more on the new suffix, in time linear in the part of it
+ * that has to be looked at. The greedy depot returns only depend on the demands, so they are replayed from the
+ * inventory at the checkpoint until the inventory matches the current tour's again after the move, from where on
+ * the depot returns are the same and their cost is a suffix aggregate. Every return adds its detour through the
+ * depot to the bound, and every stretch between returns whose straight-line distance the battery can't cover
+ * needs a charging stop, which adds at least the cheapest detour through a charging station on any of its arcs.
+ *
+ * Only moves that pass all of the screens are simulated, starting from the checkpoint at the first
+ * changed customer and with the current distance as the cutoff, see RouteEvaluator::EvaluateIncremental.
+ * A move is only kept if the simulation confirms it, so the solution's distance is always exact.
+ * With the OptimalSplit and OptimalCharging strategies the evaluator records no trace, so the bound is just the straight-line
+ * distance of the whole new customer sequence, as if the vehicle never had to leave it, and the suffix isn't screened.
+ *
+ * On large instances the search is granular: instead of every pair of positions, it only tries the
+ * moves that create an arc from a customer to one of the customers in its ProblemDefinition::GetNeighbors
+ * list, which are the only moves likely to shorten a good tour anyway. That makes a pass over a
+ * neighborhood O(n k) instead of O(n^2).
+ *
+ * The search only reads the RouteEvaluator, so one LocalSearch can be shared by every thread.
+ ******************************************************************************/
+class LocalSearch
+{
+public:
+	explicit LocalSearch(const RouteEvaluator &route_evaluator) :
+		evaluator(route_evaluator), problem_definition(route_evaluator.GetProblem())
+	{
+		granular = static_cast<int>(problem_definition.GetCustomerNodes().size()) >= GRANULAR_SEARCH_MIN_CUSTOMERS;
+	}
+
+	int Improve(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch, int max_improvements = numeric_limits<int>::max()) const;
+
+	/** Chooses between trying every move (false) and only the moves that touch the neighbor lists (true), overriding the default for the instance size */
+	void SetGranular(const bool use_neighbor_lists) { granular = use_neighbor_lists; }
+	bool IsGranular() const { return granular; }
+
+private:
+	bool TryTwoOpt(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+	bool TrySegmentMoves(solution &sol, int min_length, int max_length, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+	bool TrySwap(solution &sol, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+
+	bool TryTwoOptMove(solution &sol, int i, int j, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+	bool TrySegmentMove(solution &sol, int i, int length, int k, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+	bool TrySwapMove(solution &sol, int i, int j, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+
+	bool PassesScreening(const solution &sol, LocalSearchScratch &search_scratch, int first_changed, float delta) const;
+	bool PassesSuffixScreening(const solution &sol, LocalSearchScratch &search_scratch, int first_changed, int last_changed, float delta) const;
+	bool ConfirmMove(solution &sol, int first_changed, int last_changed, float delta, EvaluationScratch &scratch, LocalSearchScratch &search_scratch) const;
+	float DepotReturnDetour(int from, int to) const;
+	float ChargingDetour(int from, int to) const;
+	float ArcChargingDetour(const LocalSearchScratch &search_scratch, int from, int to) const;
+	float StretchChargingDetour(const LocalSearchScratch &search_scratch, int from, int begin, int end, int to) const;
+	void UpdateAggregates(const solution &sol, LocalSearchScratch &search_scratch) const;
+
+	/** The node at a position of the tour, where the positions just outside of it are the depot */
+	int NodeAt(const vector<int> &tour, const int position) const
+	{
+		return position < 0 || position >= static_cast<int>(tour.size()) ? problem_definition.GetDepotNode().index : tour[position];
+	}
+
+	const RouteEvaluator &evaluator;
+	const ProblemDefinition &problem_definition;
+	bool granular; /*!< Whether only the moves touching the neighbor lists are tried*/
+};
@@ -0,0 +1,27 @@
+#include "LocalSearchOptimizer.h"
+
+/**
+ * \brief Descends from #LOCAL_SEARCH_STARTS random tours to the nearest local optimum of each, keeping the best.
+ * Every start is improved with 2-opt, Or-opt, relocate and swap moves until none of them shortens the tour anymore,
+ * see LocalSearch. All of the local optima are kept in the found tours, so they can seed other algorithms.
+ * \param best_solution
+ */
+void LocalSearchOptimizer::Optimize(solution &best_solution)
+{
+	SolutionSet local_optima;
+	LocalSearchScratch search_scratch;
+
+	for (int i = 0; i < LOCAL_SEARCH_STARTS; i++)
+	{
+		solution start(problem_data->GenerateRandomTour());
+		local_search.Improve(start, scratch, search_scratch);
+		local_optima.AddSolutionToSet(start);
+	}
+
+	cout << "Local search simulated " << search_scratch.simulated_moves << " of " << search_scratch.screened_moves
+		<< " screened moves and made " << search_scratch.improving_moves << " of them, "
+		<< search_scratch.suffix_screened_moves << " more were ruled out by the load and battery of their suffix" << endl;
+
+	*found_tours = local_optima;
+	best_solution = local_optima.GetBestSolution();
+}
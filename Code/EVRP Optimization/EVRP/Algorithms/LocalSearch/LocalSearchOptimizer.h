@@ -0,0 +1,32 @@
+#pragma once
+#include "../AlgorithmBase.h"
+#include "LocalSearch.h"
+
+constexpr int LOCAL_SEARCH_STARTS = 100; /*!< Number of random tours the standalone local search descends from*/
+
+class LocalSearchOptimizer : public AlgorithmBase
+{
+public:
+	LocalSearchOptimizer(const ProblemDefinition *data) :
+		AlgorithmBase("Local Search", data), local_search(evaluator)
+	{
+		vector<string> hyper_parameters;
+
+		hyper_parameters.push_back(string("Random Starts: ") + to_string(LOCAL_SEARCH_STARTS));
+		hyper_parameters.push_back(string("Longest Or-opt Segment: ") + to_string(OR_OPT_MAX_SEGMENT));
+
+		SetHyperParameters(hyper_parameters);
+	}
+
+	/** Chooses which moves are tried, overriding the default for the instance size, see LocalSearch::SetGranular */
+	void SetGranularSearch(const bool use_neighbor_lists)
+	{
+		local_search.SetGranular(use_neighbor_lists);
+		SetHyperParameters({string("Granular Search: ") + (use_neighbor_lists ? "Yes" : "No")});
+	}
+
+	void Optimize(solution &best_solution) override;
+
+private:
+	LocalSearch local_search;
+};
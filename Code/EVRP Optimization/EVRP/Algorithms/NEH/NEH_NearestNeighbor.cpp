@@ -1,9 +1,14 @@
 ﻿#include "NEH_NearestNeighbor.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <functional>
 
 #include "../../HelperFunctions.h"
 #include "../../SolutionSet.h"
+#include "../../SpatialIndex.h"
+#include "../../ThreadPool.h"
 
 /**
  * \brief Uses NEH concepts to try and minimize the distance of each subtour in the route.
@@ -12,6 +17,8 @@
  * through customer nodes, where at the end of the subtour, we must return to the depot.
  * We will then use NEH concepts to order the nodes in each subtour in the way that results
  * in the minimum "makespan" of the route, aka the distance of that route.
+ * The subtours are independent of each other, so they are ordered in parallel on a ThreadPool. In multi-start
+ * mode, see SetMultiStart, they are also ordered once for every NEHOrdering, and the best tour is returned.
  * \param best_solution
  */
 void NEH_NearestNeighbor::Optimize(solution &best_solution)
@@ -23,19 +30,29 @@ void NEH_NearestNeighbor::Optimize(solution &best_solution)
 	 */
 
 	 //depot node is always node 0
-	const Node depot = problem_data->GetDepotNode();
+	const Node &depot = problem_data->GetDepotNode();
 
 	//get all customer nodes for ease of calculation in the subtour generation
-	const vector<Node> customer_nodes = problem_data->GetCustomerNodes();
+	const vector<Node> &customer_nodes = problem_data->GetCustomerNodes();
 
 	/*
 	* Beginning of Nearest Neighbor Subtour generation
 	*/
 
+	//the unvisited customers are kept in a spatial index, and every visited customer is removed from it,
+	//so finding the nearest unvisited customer takes O(log n) instead of rebuilding and scanning the unvisited list
+	vector<int> customer_indices;
+	customer_indices.reserve(customer_nodes.size());
+	for (const auto &customer : customer_nodes)
+	{
+		customer_indices.push_back(customer.index);
+	}
+	SpatialIndex unvisited_customers(problem_data->GetAllNodes(), customer_indices);
+
 	vector<vector<Node>> subtours;
-	vector<Node> visited_nodes;
+	size_t visited_count = 0;
 
-	while (visited_nodes.size() < customer_nodes.size())
+	while (visited_count < customer_nodes.size())
 	{
 		//track the current subtour
 		vector<Node> subtour;
@@ -50,7 +67,10 @@ void NEH_NearestNeighbor::Optimize(solution &best_solution)
 		while (true)
 		{
 			//get the nearest unvisited node to the current node. the current node is the depot on the first iteration 
-			const Node nearest = GetNearestUnvisitedNode(customer_nodes, visited_nodes, current);
+			//customers within a distance of 1 are skipped like they always have been, unless they are the only ones left
+			int nearest_index = unvisited_customers.Nearest(current.x, current.y, current.index, 1.0);
+			if (nearest_index == -1) nearest_index = unvisited_customers.Nearest(current.x, current.y, current.index);
+			const Node &nearest = problem_data->GetNodeFromIndex(nearest_index);
 
 			//if the nearest demand is too large for our current capacity, we must return to the depot aka this subtour is over
 			if (nearest.demand > capacity) break;
@@ -63,10 +83,11 @@ void NEH_NearestNeighbor::Optimize(solution &best_solution)
 
 			//"visit" the current node
 			subtour.push_back(current);
-			visited_nodes.push_back(current);
+			unvisited_customers.Remove(current.index);
+			visited_count++;
 
 			//if we have visited all the customer nodes, this is the end of the current subtour
-			if (visited_nodes.size() == customer_nodes.size())
+			if (visited_count == customer_nodes.size())
 			{
 				break;
 			}
@@ -114,149 +135,198 @@ void NEH_NearestNeighbor::Optimize(solution &best_solution)
 
 
 	//now we have all of the subtours required for this route
-	//we now need to implement NEH concepts to find the best ordering of each element in each subtour
-	vector<solution> optimal_subtours;
-	optimal_subtours.reserve(subtours.size());
+	//we now need to implement NEH concepts to find the best ordering of each element in each subtour,
+	//once for every ordering of the customers that gets tried
+	vector<NEHOrdering> orderings = {NearestNeighborOrdering};
+	if (multi_start)
+	{
+		orderings.insert(orderings.end(), {DemandOrdering, DepotDistanceOrdering, PolarAngleOrdering});
+		orderings.insert(orderings.end(), random_ordering_count, RandomOrdering);
+	}
 
-	for (const auto& subtour : subtours)
+	//the subtours don't share any customers, so every subtour of every ordering is built on its own.
+	//task t builds subtour t % subtour_count of ordering t / subtour_count, and writes it to its own slot
+	const int subtour_count = static_cast<int>(subtours.size());
+	const int task_count = static_cast<int>(orderings.size()) * subtour_count;
+	vector<solution> optimal_subtours(task_count);
+
+	ThreadPool pool(min(worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount(), max(1, task_count)));
+	vector<EvaluationScratch> worker_scratch;
+	worker_scratch.reserve(pool.GetWorkerCount());
+	for (int worker = 0; worker < pool.GetWorkerCount(); worker++)
 	{
-		optimal_subtours.push_back(NEH_Calculation(subtour));
+		worker_scratch.emplace_back(problem_data);
 	}
 
+	pool.ParallelFor(task_count, [&](const int worker, const int task)
+	{
+		//the random stream belongs to the task, so the orderings don't depend on the worker count. Creating it takes constant time, see RandomGenerator
+		RandomGenerator generator(random_seed, static_cast<uint64_t>(task));
+		vector<int> insertion_order = HelperFunctions::GetIndexEncodedTour(subtours[task % subtour_count]);
+		OrderInsertions(insertion_order, orderings[task / subtour_count], generator);
+		optimal_subtours[task] = NEH_Calculation(insertion_order, worker_scratch[worker]);
+	});
+
 	//now we have all of the subtours optimized as far as NEH can, so now we
-	//combine them all into one complete tour and calculate the distance
-	solution best_tour = {};
-	for (const auto& subtour : optimal_subtours)
+	//combine them all into one complete tour per ordering and calculate the distance.
+	//every tour is kept, so a GA seeded by NEH starts from all of them
+	best_solution = {};
+	best_solution.distance = NO_EVALUATION_CUTOFF;
+	for (size_t ordering = 0; ordering < orderings.size(); ordering++)
 	{
-		for (const auto& node : subtour.tour)
+		solution tour = {};
+		for (int subtour = 0; subtour < subtour_count; subtour++)
 		{
-			best_tour.tour.push_back(node);
+			const vector<int> &nodes = optimal_subtours[ordering * subtour_count + subtour].tour;
+			tour.tour.insert(tour.tour.end(), nodes.begin(), nodes.end());
 		}
-	}
 
-	best_tour.distance = vehicle->SimulateDrive(best_tour.tour);
-	best_solution = best_tour;
-	found_tours->AddSolutionToSet(best_solution);
+		tour.distance = evaluator.Evaluate(tour.tour, scratch).distance;
+		found_tours->AddSolutionToSet(tour);
+		if (tour.distance < best_solution.distance) best_solution = tour;
+	}
 	//cout << bestDistance << endl;
 }
 
 /**
- * \brief Find the closest node to the provided node while filtering the graph by nodes we have already visited.
- * \param customer_nodes All customer nodes in this problem instance
- * \param visited_nodes All nodes we have already visited in previous iterations
- * \param node We want to find the closest unvisited node to this node
- * \return We return the closest node to the node param
+ * \brief Tries every NEHOrdering instead of only the nearest neighbor one, and keeps the best tour.
+ * The orderings are built in parallel with the rest of the subtours, so this costs little extra time on a machine
+ * with enough threads, and every ordering's tour goes into the found tours as a diverse set of seeds.
+ * \param random_orderings The number of random orderings to try on top of the fixed ones
  */
-Node NEH_NearestNeighbor::GetNearestUnvisitedNode(const vector<Node>& customer_nodes, const vector<Node>& visited_nodes,
-	const Node& node)
+void NEH_NearestNeighbor::SetMultiStart(const int random_orderings)
 {
-	vector<Node> unvisited_nodes;
-	for (const auto& customer : customer_nodes)
-	{
-		bool has_visited = false;
-		for (const auto& visited : visited_nodes)
-		{
-			if (customer.index == visited.index)
-			{
-				has_visited = true;
-			}
-		}
-		if (!has_visited)
-		{
-			unvisited_nodes.push_back(customer);
-		}
-	}
-	//we just call GetNearestNode on the unvisited node subset of the complete customer graph
-	return GetNearestNode(unvisited_nodes, node);
+	multi_start = true;
+	random_ordering_count = max(0, random_orderings);
+
+	vector<string> hyper_parameters;
+	hyper_parameters.push_back(string("Multi-Start Random Orderings: ") + to_string(random_ordering_count));
+	SetHyperParameters(hyper_parameters);
 }
 
 /**
- * \brief Find the nearest node to any given node out of a set of possible nodes.
- * \param customer_nodes All customer nodes in which to search
- * \param node The node that we are searching around
- * \return The closest node to the input node param
+ * \brief Sorts the customers of a subtour into the order NEH inserts them in.
+ * \param insertion_order The customers of the subtour in nearest neighbor order, sorted in place
+ * \param ordering The order to sort them into
+ * \param generator The random number stream a random ordering is shuffled with
  */
-Node NEH_NearestNeighbor::GetNearestNode(const vector<Node>& customer_nodes, const Node& node)
+void NEH_NearestNeighbor::OrderInsertions(vector<int> &insertion_order, const NEHOrdering ordering, RandomGenerator &generator) const
 {
-	Node closest_node = node;
-	float smallest_distance = numeric_limits<float>::max();
-	for (const auto& other : customer_nodes)
+	const Node &depot = problem_data->GetDepotNode();
+	const auto by_key = [&](const function<float(const Node &)> &key)
 	{
-		const float node_distance = HelperFunctions::CalculateInterNodeDistance(node, other);
-		if (node_distance < smallest_distance && node_distance > 1)
+		//stable, so customers with the same key stay in nearest neighbor order
+		stable_sort(insertion_order.begin(), insertion_order.end(), [&](const int a, const int b)
 		{
-			closest_node = other;
-			smallest_distance = node_distance;
-		}
+			return key(problem_data->GetNodeFromIndex(a)) < key(problem_data->GetNodeFromIndex(b));
+		});
+	};
+
+	switch (ordering)
+	{
+	case NearestNeighborOrdering:
+		break;
+	case DemandOrdering:
+		by_key([](const Node &node) { return -static_cast<float>(node.demand); });
+		break;
+	case DepotDistanceOrdering:
+		by_key([&](const Node &node) { return -problem_data->Distance(depot, node); });
+		break;
+	case PolarAngleOrdering:
+		by_key([&](const Node &node) { return static_cast<float>(atan2(node.y - depot.y, node.x - depot.x)); });
+		break;
+	case RandomOrdering:
+		HelperFunctions::ShuffleVector(insertion_order, generator);
+		break;
 	}
-	return closest_node;
 }
 
 /**
  * \brief Use NEH concepts to find the best ordering of nodes in each subtour.
  * we need to figure out the optimal ordering of the nodes in the subtour to minimize the distance
  * in each subtour. We will use NEH concepts to do this.
- * \param subtour The unoptimized subtour generated by the nearest neighbor approach
+ *
+ * Every insertion point gets a lower bound on the distance of the subtour with the node inserted there: the
+ * straight-line length of the partial subtour, from the depot and back, plus the cost of the insertion. The
+ * length up to and after each point is summed up once per step, so every bound takes O(1). Charging detours and
+ * depot returns can only make a tour longer than its straight-line length, so the insertion points are simulated
+ * in order of their bound, and once a bound is over the best distance simulated so far, none of the remaining
+ * points can win. Most of the time the insertion with the best bound needs no charging stop, and it is the only
+ * one that gets simulated.
+ * \param insertion_order The customers of the subtour, in the order they get inserted, see OrderInsertions
+ * \param neh_scratch Buffers owned by the calling thread for the simulations
  * \return The optimal ordering of the nodes inside the given subtour
  */
-solution NEH_NearestNeighbor::NEH_Calculation(const solution &subtour) const
+solution NEH_NearestNeighbor::NEH_Calculation(const vector<int> &insertion_order, EvaluationScratch &neh_scratch) const
 {
 	//if there is only one node in the subtour, we want to return. it is already "ordered"
-	if (subtour.tour.size() == 1) return { subtour };
-
-	//take the provided Node subtour and construct a list of just these node's indices because
-	//the vehicle SimulateDrive method takes an integer index-encoded tour
-	const vector<int> index_encoded_subtour = HelperFunctions::GetIndexEncodedTour(subtour.tour);
+	if (insertion_order.size() == 1) return solution(insertion_order);
 
-	//start with L = 2
-	int L = 2;
+	const int depot = problem_data->GetDepotNode().index;
+	solution best_subtour = {{insertion_order[0]}};
 
+	//prefix_length[i] is the straight-line length from the depot through the first i nodes, suffix_length[i] from node i on back to the depot
+	vector<float> prefix_length;
+	vector<float> suffix_length;
+	vector<pair<float, size_t>> insertion_bounds;
+	vector<int> temp_subtour;
 
-	//the complete partial subtour, which starts with element 0 of the provided subtour
-	//vector<Node> partial_subtour;
-	//partial_subtour.push_back(subtour.tour[0]);
-
-	solution best_subtour = {{subtour.tour[0]}};
-
-	
-	
-	//iterate until L = subtour size + 1
-	do
+	//insert the nodes of the subtour one at a time, at the point that keeps the partial subtour shortest
+	for (size_t L = 1; L < insertion_order.size(); L++)
 	{
-		//vector to track the best partial subtour (aka the partial subtour with the smallest "makespan")
-		//vector<Node> best_partial;
-		
-		//start with the current best distance equal to the largest float number
-		//float best_dist = numeric_limits<float>::max();
+		const vector<int> &partial = best_subtour.tour;
+		const int inserted = insertion_order[L];
+		const size_t points = partial.size() + 1;
 
-		auto *partial_solutions = new SolutionSet();
-
-		//we insert the next node into every possible point inside of the current subtour and calculate the distance
-		for (size_t i = 0; i < best_subtour.tour.size() + 1; i++)
+		prefix_length.assign(points, 0.f);
+		suffix_length.assign(points, 0.f);
+		for (size_t i = 1; i < points; i++)
 		{
-			//create a temporary subtour vector that we can insert an element into
-			//we create this temporary subtour every iteration so that we don't need to remove the element
-			//it'll just override each iteration. we could definitely just remove the inserted element after 
-			//calculating, if this becomes an issue
-			vector<Node> temp_subtour = best_subtour.tour;
+			prefix_length[i] = prefix_length[i - 1] + problem_data->Distance(i == 1 ? depot : partial[i - 2], partial[i - 1]);
+		}
+		for (size_t i = points - 1; i-- > 0;)
+		{
+			suffix_length[i] = suffix_length[i + 1] + problem_data->Distance(partial[i], i + 1 == partial.size() ? depot : partial[i + 1]);
+		}
 
-			//create a vector iterator at index i of the temporary subtour vector
-			const auto index = temp_subtour.begin() + static_cast<long long>(i);
+		insertion_bounds.clear();
+		for (size_t i = 0; i < points; i++)
+		{
+			const int before = i == 0 ? depot : partial[i - 1];
+			const int after = i == partial.size() ? depot : partial[i];
+			const float bound = prefix_length[i] + problem_data->Distance(before, inserted) + problem_data->Distance(inserted, after) + suffix_length[i];
+			insertion_bounds.emplace_back(bound, i);
+		}
+		sort(insertion_bounds.begin(), insertion_bounds.end());
+
+		//only the best insertion is kept, so every other insertion is only simulated until it is worse than the best one so far.
+		//ties go to the earliest insertion point, the same as trying every point in order would
+		solution best_partial = {};
+		size_t best_point = points;
+		float best_partial_distance = NO_EVALUATION_CUTOFF;
+		for (const auto &insertion : insertion_bounds)
+		{
+			//the bound sums the legs in a different order than the simulation, so it gets a little slack for rounding
+			const float bound = insertion.first * (1.f - NEH_BOUND_TOLERANCE);
+			if (bound > best_partial_distance) break;
 
-			//insert element L (index L - 1) into the subtour
-			temp_subtour.insert(index, subtour.tour[L - 1]);
+			temp_subtour.assign(partial.begin(), partial.end());
+			temp_subtour.insert(temp_subtour.begin() + static_cast<long long>(insertion.second), inserted);
 
-			//calculate the distance of the partial subtour (all constraints are implemented in Vehicle::SimulateDrive)
-			solution temp_solution = {temp_subtour, vehicle->SimulateDrive(temp_subtour)};
-			partial_solutions->AddSolutionToSet(temp_solution);
+			//calculate the distance of the partial subtour (all constraints are implemented in RouteEvaluator::Evaluate)
+			const EvaluationResult result = evaluator.Evaluate(temp_subtour, best_partial_distance, neh_scratch);
+			if (result.dominated) continue;
+			if (result.distance < best_partial_distance || (result.distance == best_partial_distance && insertion.second < best_point))
+			{
+				best_partial = {temp_subtour, result.distance};
+				best_partial_distance = result.distance;
+				best_point = insertion.second;
+			}
 		}
-		//copy the best subtour into partial_subtour
-		//the best partial subtour will have 1 additional element, so this operation increases the size of the partial_subtour by 1
-		best_subtour = partial_solutions->GetBestSolution();
 
-		//Increment L so that the next iteration will sort the next element with NEH methodologies
-		L++;
-	} while (static_cast<size_t>(L) < subtour.tour.size() + 1);
+		//the best partial subtour has 1 additional element, so this increases the size of the partial subtour by 1
+		best_subtour = std::move(best_partial);
+	}
 
 	//return the subtour 
 	return best_subtour;
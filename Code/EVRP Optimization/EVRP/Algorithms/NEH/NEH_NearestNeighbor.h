@@ -1,7 +1,25 @@
 ﻿#pragma once
 #include "../AlgorithmBase.h"
+#include "../../RandomGenerator.h"
+#include "../../ThreadPool.h"
 #include <map>
 
+constexpr float NEH_BOUND_TOLERANCE = 1e-5f; /*!< Relative slack on the straight-line bound of an insertion, for the rounding of the simulated distance */
+constexpr int NEH_WORKER_THREADS = 0; /*!< Number of threads that build subtours in parallel. 0 uses every hardware thread */
+constexpr int NEH_RANDOM_ORDERINGS = 16; /*!< Number of random insertion orders tried in multi-start mode, on top of the fixed ones */
+
+/**
+ * The order in which NEH inserts the customers of a subtour into it. NEH is greedy, so the same customers
+ * inserted in a different order usually end up in a different subtour.
+ */
+enum NEHOrdering
+{
+    NearestNeighborOrdering, /*!< The order the nearest neighbor walk visited them in*/
+    DemandOrdering, /*!< Largest demand first*/
+    DepotDistanceOrdering, /*!< Farthest from the depot first*/
+    PolarAngleOrdering, /*!< Sweeping counterclockwise around the depot*/
+    RandomOrdering /*!< Shuffled*/
+};
 
 class NEH_NearestNeighbor : public AlgorithmBase
 {
@@ -14,6 +32,10 @@ public:
         SetHyperParameters(hyper_parameters);
     }
 
+    void SetWorkerCount(const int workers) override { worker_count = workers; }
+    int GetWorkerCount() const override { return worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount(); }
+    void SetRandomSeed(const uint64_t seed) { random_seed = seed; }
+    void SetMultiStart(int random_orderings = NEH_RANDOM_ORDERINGS);
     void Optimize(solution &best_solution) override;
 
 private:
@@ -23,7 +45,11 @@ private:
         map<Node, float> distance_map;
     } node_distances;
 
-    static Node GetNearestUnvisitedNode(const vector<Node> &customer_nodes, const vector<Node> &visited_nodes, const Node &node);
-    static Node GetNearestNode(const vector<Node> &customer_nodes, const Node &node);
-    solution NEH_Calculation(const solution &subtour) const;
+    void OrderInsertions(vector<int> &insertion_order, NEHOrdering ordering, RandomGenerator &generator) const;
+    solution NEH_Calculation(const vector<int> &insertion_order, EvaluationScratch &neh_scratch) const;
+
+    int worker_count = NEH_WORKER_THREADS; /*!< Number of workers in the thread pool, see #NEH_WORKER_THREADS*/
+    bool multi_start = false; /*!< Whether every ordering is tried instead of only the nearest neighbor one, see SetMultiStart*/
+    int random_ordering_count = 0; /*!< Number of random orderings tried in multi-start mode*/
+    uint64_t random_seed = RandomGenerator::GetRunSeed(); /*!< Seeds the random orderings, so runs with the same seed are reproducible*/
 };
@@ -1,40 +1,105 @@
 #include "RandomSearchOptimizer.h"
 
+#include <algorithm>
+
 #include "../../HelperFunctions.h"
 #include "../../SolutionSet.h"
+#include "../../ThreadPool.h"
+
+/**
+ * \brief Sets how many random solutions are generated, see Optimize. Memory use doesn't depend on the number of solutions,
+ * only on the number that is kept, so the budget can be raised as far as there is time for.
+ * \param generations The number of generations
+ * \param solutions_per_generation The number of random solutions in every generation
+ * \param kept_solutions The number of generation bests that are kept as found tours
+ */
+void RandomSearchOptimizer::SetSampleBudget(const int generations, const int solutions_per_generation, const int kept_solutions)
+{
+	generation_count = max(1, generations);
+	generation_size = max(1, solutions_per_generation);
+	kept_count = max(1, kept_solutions);
+
+	vector<string> hyper_parameters;
+	hyper_parameters.push_back(string("Generations: ") + to_string(generation_count));
+	hyper_parameters.push_back(string("Solutions per Generation: ") + to_string(generation_size));
+	hyper_parameters.push_back(string("Number of Best Solutions: ") + to_string(kept_count));
+	SetHyperParameters(hyper_parameters);
+}
 
 /**
  * \brief Generate #NUM_GENERATIONS * #SOLUTIONS_PER_GENERATION random solutions, saving the best from each generation.
  * We use random generation to generate #SOLUTIONS_PER_GENERATION purely random solutions. We save the best one, and
  * do this #NUM_GENERATIONS times. By the end, we will have #NUM_GENERATIONS "good" solutions. This could be used as
  * a good seed for other algorithms that start with an initial population.
+ *
+ * The generations are split across a ThreadPool. Every worker keeps a heap of the best generation bests it has found,
+ * no more of them than are kept in the end, and a generation whose best can't make it into the heap is only simulated
+ * until it is worse than the worst one in it. Each worker only writes to its own heap, and the heaps are merged once
+ * the pool is done, so the workers never wait on each other, and memory use only grows with the number of kept
+ * solutions, not with the number of solutions generated. Every generation has its own random stream, so the result is
+ * the same on any number of workers.
  * \param best_solution
  */
 void RandomSearchOptimizer::Optimize(solution &best_solution)
 {
-	auto* best_solutions = new SolutionSet();
+	SetHyperParameters({string("Random Seed: ") + to_string(random_seed)});
+	ThreadPool pool(min(worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount(), generation_count));
+	const int workers = pool.GetWorkerCount();
 
-	for (int i = 0; i < NUM_GENERATIONS; i++)
+	//the heaps have the worst of the kept generation bests on top
+	vector<vector<GenerationBest>> worker_best(workers);
+	vector<EvaluationScratch> worker_scratch;
+	vector<vector<int>> worker_tour(workers);
+	worker_scratch.reserve(workers);
+	for (int worker = 0; worker < workers; worker++)
 	{
-		auto* generation_solutions = new SolutionSet();
-		
-		for (int j = 0; j < SOLUTIONS_PER_GENERATION; j++)
+		worker_scratch.emplace_back(problem_data);
+		worker_best[worker].reserve(kept_count + 1);
+	}
+
+	pool.ParallelFor(generation_count, [&](const int worker, const int generation)
+	{
+		vector<GenerationBest> &heap = worker_best[worker];
+		const bool heap_full = static_cast<int>(heap.size()) == kept_count;
+		const float cutoff = heap_full ? heap.front().best.distance : NO_EVALUATION_CUTOFF;
+
+		GenerationBest candidate = {SearchGeneration(generation, cutoff, worker_tour[worker], worker_scratch[worker]), generation};
+		if (candidate.best.tour.empty()) return;
+		if (heap_full && !IsBetter(candidate, heap.front())) return;
+
+		heap.push_back(std::move(candidate));
+		push_heap(heap.begin(), heap.end(), IsBetter);
+		if (static_cast<int>(heap.size()) > kept_count)
 		{
-			vector<Node> tour = problem_data->GenerateRandomTour();
-			generation_solutions->AddSolutionToSet({tour, vehicle->SimulateDrive(tour)});
+			pop_heap(heap.begin(), heap.end(), IsBetter);
+			heap.pop_back();
 		}
-		best_solutions->AddSolutionToSet(generation_solutions->GetBestSolution());
+	});
+
+	//every generation best that is among the best overall is also among the best of its worker
+	vector<GenerationBest> merged;
+	for (auto &heap : worker_best)
+	{
+		merged.insert(merged.end(), make_move_iterator(heap.begin()), make_move_iterator(heap.end()));
+	}
+	sort(merged.begin(), merged.end(), IsBetter);
+	merged.resize(min(merged.size(), static_cast<size_t>(kept_count)));
+
+	SolutionSet best_solutions;
+	for (const auto &generation_best : merged)
+	{
+		best_solutions.AddSolutionToSet(generation_best.best);
 	}
 
-	found_tours = new SolutionSet(best_solutions);
-	best_solution = best_solutions->GetBestSolution();
+	*found_tours = best_solutions;
+	best_solution = best_solutions.GetBestSolution();
 	
 
 
 	/*
 	cout << "Best tour: ";
 	HelperFunctions::PrintTour(bestTour);
-	cout << "The best tour has distance breakdown: " << vehicle->SimulateDrive(bestTour, true) << endl;
+	cout << "The best tour has distance breakdown: " << evaluator.Evaluate(bestTour, scratch, true).distance << endl;
 
 	cout << "Number of \"best\" solutions in solution map: " << bestSolutions.size() << endl;
 	for (auto iter : bestSolutions)
@@ -45,3 +110,45 @@ void RandomSearchOptimizer::Optimize(solution &best_solution)
 	}
 	*/
 }
+
+/**
+ * \brief Orders generation bests by distance, and by generation if the distances are the same.
+ */
+bool RandomSearchOptimizer::IsBetter(const GenerationBest &a, const GenerationBest &b)
+{
+	return a.best.distance < b.best.distance || (a.best.distance == b.best.distance && a.generation < b.generation);
+}
+
+/**
+ * \brief Generates the random solutions of one generation and finds the best of them.
+ * \param generation The generation, which picks its random stream. Creating the stream takes constant time, so raising the number of generations only costs the samples
+ * \param cutoff Solutions that aren't shorter than this are of no use, so they are only simulated until they go over it
+ * \param tour A buffer owned by the calling thread that every random solution is shuffled in
+ * \param worker_scratch Buffers owned by the calling thread for the simulations
+ * \return The best solution of the generation, or an empty one if none came in under the cutoff
+ */
+solution RandomSearchOptimizer::SearchGeneration(const int generation, const float cutoff, vector<int> &tour, EvaluationScratch &worker_scratch) const
+{
+	RandomGenerator generator(random_seed, static_cast<uint64_t>(generation));
+	tour.clear();
+	for (const auto &customer : problem_data->GetCustomerNodes())
+	{
+		tour.push_back(customer.index);
+	}
+
+	//only the best solution of each generation is kept, so every other tour is only simulated until it is worse than that
+	solution generation_best = {};
+	float generation_best_distance = cutoff;
+	for (int j = 0; j < generation_size; j++)
+	{
+		HelperFunctions::ShuffleVector(tour, generator);
+		const EvaluationResult result = evaluator.Evaluate(tour, generation_best_distance, worker_scratch);
+		if (!result.dominated && result.distance < generation_best_distance)
+		{
+			generation_best.tour.assign(tour.begin(), tour.end());
+			generation_best.distance = result.distance;
+			generation_best_distance = result.distance;
+		}
+	}
+	return generation_best;
+}
@@ -1,8 +1,11 @@
 #pragma once
 #include "../AlgorithmBase.h"
+#include "../../ThreadPool.h"
 
 constexpr int SOLUTIONS_PER_GENERATION = 500; /*!< The number of solutions that will be randomly generated. Of n solutions, the top 1 will be saved */
 constexpr int NUM_GENERATIONS = 100; /*!< Number of "best" solutions desired, 1 from every "generation" */
+constexpr int SEED_SAMPLE_MULTIPLIER = 100; /*!< How many times #SOLUTIONS_PER_GENERATION the Random Search generates per generation when it seeds the GA, see EVRP_Solver::SolveEVRP_Seed */
+constexpr int RANDOM_SEARCH_WORKER_THREADS = 0; /*!< Number of threads that generate and evaluate solutions in parallel. 0 uses every hardware thread */
 
 class RandomSearchOptimizer : public AlgorithmBase
 {
@@ -17,6 +20,27 @@ public:
 
         SetHyperParameters(hyper_parameters);
     }
-    
+
+    void SetWorkerCount(const int workers) override { worker_count = workers; }
+    int GetWorkerCount() const override { return worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount(); }
+    void SetRandomSeed(const uint64_t seed) { random_seed = seed; }
+    void SetSampleBudget(int generations, int solutions_per_generation, int kept_solutions = NUM_GENERATIONS);
     void Optimize(solution &best_solution) override;
+
+private:
+    /** The best solution of a generation, and the generation it came from to break ties the same way on any number of workers */
+    struct GenerationBest
+    {
+        solution best;
+        int generation;
+    };
+
+    static bool IsBetter(const GenerationBest &a, const GenerationBest &b);
+    solution SearchGeneration(int generation, float cutoff, vector<int> &tour, EvaluationScratch &worker_scratch) const;
+
+    int worker_count = RANDOM_SEARCH_WORKER_THREADS; /*!< Number of workers in the thread pool, see #RANDOM_SEARCH_WORKER_THREADS*/
+    int generation_count = NUM_GENERATIONS; /*!< Number of generations, each searched by one worker*/
+    int generation_size = SOLUTIONS_PER_GENERATION; /*!< Number of random solutions in every generation*/
+    int kept_count = NUM_GENERATIONS; /*!< Number of generation bests that are kept as found tours*/
+    uint64_t random_seed = RandomGenerator::GetRunSeed(); /*!< Seeds the random stream of every generation, so runs with the same seed are reproducible on any number of workers*/
 };
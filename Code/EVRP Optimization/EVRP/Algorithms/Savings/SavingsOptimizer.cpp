@@ -0,0 +1,158 @@
+#include "SavingsOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../../SolutionSet.h"
+
+/**
+ * \brief Builds solutions with the parallel savings algorithm of Clarke and Wright (1964).
+ * Every customer starts out on a route of its own, from the depot and back. Joining the route that ends at customer i
+ * with the route that starts at customer j saves the trips from i back to the depot and from the depot out to j, at the
+ * cost of driving from i to j, and the savings are tried from the largest down. A join is made if both customers are
+ * still at an end of their routes, the load of both routes fits in the vehicle, and the vehicle can drive the joined
+ * route without getting stranded, with the same charging detours the RouteEvaluator takes for any route. The joined
+ * route is simulated, and it is only kept if it really is shorter than the two routes were, since a longer route can
+ * need more detours to chargers than the savings make up for.
+ *
+ * Only the savings between every customer and the customers on its candidate list (ProblemDefinition::GetNeighbors)
+ * are computed, the joins between customers far apart save little anyway. They are kept in a heap, so for n customers
+ * with k candidates each, building a solution takes O(n k log(n k)) plus one simulation of a route per join tried.
+ *
+ * A solution is built for every route shape in #SAVINGS_ROUTE_SHAPES, which weighs the distance between the joined
+ * customers against the savings on the depot trips (Yellow, 1970): a larger shape prefers routes that go out and back
+ * along a narrow wedge, a smaller one routes that sweep around the depot. Every solution goes into the found tours, so a
+ * GA seeded with savings gets a handful of different good starts, and the best one is returned.
+ * \param best_solution
+ */
+void SavingsOptimizer::Optimize(solution &best_solution)
+{
+	best_solution = {};
+	best_solution.distance = NO_EVALUATION_CUTOFF;
+	for (const float route_shape : SAVINGS_ROUTE_SHAPES)
+	{
+		const solution built = BuildSolution(route_shape);
+		found_tours->AddSolutionToSet(built);
+		if (built.distance < best_solution.distance) best_solution = built;
+	}
+}
+
+/**
+ * \brief Computes the savings of every customer with the customers on its candidate list, and puts them in the heap.
+ * \param route_shape How much the distance between the joined customers weighs in the saving, see Optimize
+ */
+void SavingsOptimizer::ComputeSavings(const float route_shape)
+{
+	const int depot = problem_data->GetDepotNode().index;
+	const int neighbor_count = problem_data->GetNeighborCount();
+
+	savings.clear();
+	for (const auto &customer : problem_data->GetCustomerNodes())
+	{
+		const int *neighbors = problem_data->GetNeighbors(customer.index);
+		for (int k = 0; k < neighbor_count; k++)
+		{
+			//a pair that is on both candidate lists is tried twice, but the second time the customers already share a route or the join fails again
+			const int neighbor = neighbors[k];
+			const float value = problem_data->Distance(customer.index, depot) + problem_data->Distance(depot, neighbor) - route_shape * problem_data->Distance(customer.index, neighbor);
+			if (value > 0.f) savings.push_back({value, customer.index, neighbor});
+		}
+	}
+
+	make_heap(savings.begin(), savings.end(), IsSmallerSaving);
+}
+
+/**
+ * \brief Orders the savings by value, and by the customers if the values are the same so that the heap pops them in a fixed order.
+ */
+bool SavingsOptimizer::IsSmallerSaving(const Saving &a, const Saving &b)
+{
+	return a.value < b.value || (a.value == b.value && (a.from > b.from || (a.from == b.from && a.to > b.to)));
+}
+
+/**
+ * \brief Builds one solution with the savings algorithm, see Optimize.
+ * \param route_shape How much the distance between the joined customers weighs in the saving
+ * \return The routes in the order of their polar angle around the depot, so a tour that spills over into the next
+ * route when it is split greedily spills into a route close by
+ */
+solution SavingsOptimizer::BuildSolution(const float route_shape)
+{
+	const vector<Node> &customers = problem_data->GetCustomerNodes();
+	const int capacity = problem_data->GetVehicleParameters().load_capacity;
+
+	//every customer starts on a route of its own
+	routes.assign(customers.size(), {});
+	route_distance.assign(customers.size(), 0.f);
+	route_load.assign(customers.size(), 0);
+	route_of.assign(problem_data->GetNodeCount(), -1);
+	for (size_t route = 0; route < customers.size(); route++)
+	{
+		routes[route].push_back(customers[route].index);
+		route_distance[route] = evaluator.Evaluate(routes[route], scratch).distance;
+		route_load[route] = customers[route].demand;
+		route_of[customers[route].index] = static_cast<int>(route);
+	}
+
+	ComputeSavings(route_shape);
+	while (!savings.empty())
+	{
+		pop_heap(savings.begin(), savings.end(), IsSmallerSaving);
+		const Saving saving = savings.back();
+		savings.pop_back();
+
+		const int first = route_of[saving.from];
+		const int second = route_of[saving.to];
+		if (first == second || route_load[first] + route_load[second] > capacity) continue;
+
+		//only customers at an end of their routes can be joined, the routes are turned around to put them next to each other
+		const vector<int> &first_route = routes[first];
+		const vector<int> &second_route = routes[second];
+		if (first_route.front() != saving.from && first_route.back() != saving.from) continue;
+		if (second_route.front() != saving.to && second_route.back() != saving.to) continue;
+
+		merged_route.clear();
+		if (first_route.back() == saving.from) merged_route.insert(merged_route.end(), first_route.begin(), first_route.end());
+		else merged_route.insert(merged_route.end(), first_route.rbegin(), first_route.rend());
+		if (second_route.front() == saving.to) merged_route.insert(merged_route.end(), second_route.begin(), second_route.end());
+		else merged_route.insert(merged_route.end(), second_route.rbegin(), second_route.rend());
+
+		const float separate_distance = route_distance[first] + route_distance[second];
+		const EvaluationResult result = evaluator.Evaluate(merged_route, separate_distance, scratch);
+		if (result.dominated || !result.feasible || result.distance >= separate_distance) continue;
+
+		for (const int customer : second_route)
+		{
+			route_of[customer] = first;
+		}
+		routes[first].swap(merged_route);
+		routes[second].clear();
+		route_distance[first] = result.distance;
+		route_load[first] += route_load[second];
+	}
+
+	//lay the routes out one after another, sweeping around the depot
+	const Node &depot = problem_data->GetDepotNode();
+	vector<pair<double, int>> route_angles;
+	for (size_t route = 0; route < routes.size(); route++)
+	{
+		if (routes[route].empty()) continue;
+		double x = 0.0;
+		double y = 0.0;
+		for (const int customer : routes[route])
+		{
+			x += problem_data->GetNodeFromIndex(customer).x - depot.x;
+			y += problem_data->GetNodeFromIndex(customer).y - depot.y;
+		}
+		route_angles.emplace_back(atan2(y, x), static_cast<int>(route));
+	}
+	sort(route_angles.begin(), route_angles.end());
+
+	solution built = {};
+	for (const auto &route_angle : route_angles)
+	{
+		built.tour.insert(built.tour.end(), routes[route_angle.second].begin(), routes[route_angle.second].end());
+	}
+	built.distance = evaluator.Evaluate(built.tour, scratch).distance;
+	return built;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "../AlgorithmBase.h"
+
+constexpr float SAVINGS_ROUTE_SHAPES[] = {1.0f, 0.6f, 0.8f, 1.2f, 1.4f, 1.6f, 1.8f, 2.0f}; /*!< The route shape parameters a solution is built for, see SavingsOptimizer */
+
+class SavingsOptimizer : public AlgorithmBase
+{
+public:
+    SavingsOptimizer(const ProblemDefinition *data) :
+        AlgorithmBase("Clarke-Wright Savings", data)
+    {
+        vector<string> hyper_parameters;
+
+        hyper_parameters.push_back(string("Route Shapes: ") + to_string(sizeof(SAVINGS_ROUTE_SHAPES) / sizeof(SAVINGS_ROUTE_SHAPES[0])));
+        hyper_parameters.push_back(string("Savings per Customer: ") + to_string(data->GetNeighborCount()));
+
+        SetHyperParameters(hyper_parameters);
+    }
+
+    void Optimize(solution &best_solution) override;
+
+private:
+    /** Joining the route that ends at customer from with the route that starts at customer to saves value */
+    struct Saving
+    {
+        float value;
+        int from;
+        int to;
+    };
+
+    static bool IsSmallerSaving(const Saving &a, const Saving &b);
+    solution BuildSolution(float route_shape);
+    void ComputeSavings(float route_shape);
+
+    vector<Saving> savings; /*!< A max-heap of the savings that haven't been tried yet*/
+    vector<vector<int>> routes; /*!< The customers of every route, in the order they are driven. Merged routes are left empty*/
+    vector<float> route_distance; /*!< The simulated distance of every route*/
+    vector<int> route_load; /*!< The total demand of every route*/
+    vector<int> route_of; /*!< The route every customer is on, by node index*/
+    vector<int> merged_route; /*!< Buffer for the route a saving would create*/
+};
@@ -0,0 +1,562 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "HelperFunctions.h"
+#include "RouteEvaluator.h"
+#include "SolutionSet.h"
+#include "Algorithms/GA/GeneticAlgorithmOptimizer.h"
+#include "Algorithms/LocalSearch/LocalSearch.h"
+
+/**
+* Compares the cost of the distance calculations in a fitness evaluation with and without the precomputed distance matrix.
+*
+* The "hypot" timing is what every arc of every evaluation used to cost before ProblemDefinition precomputed
+* the matrix, and the "matrix" timing is what it costs now. Only the arc cost is compared before and after: the
+* evaluator that computed its distances with hypot() no longer exists, so there is no "before" timing of a full
+* evaluation. The last timing is a complete RouteEvaluator::Evaluate as it is now, to put the arc cost in the
+* context of a full evaluation.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::DistanceMatrix(const ProblemDefinition *problem)
+{
+	const vector<vector<int>> tours = GenerateTours(problem, BENCHMARK_TOURS);
+	const Node &depot = problem->GetDepotNode();
+
+	//the checksums keep the compiler from optimizing the loops away, and should match between both methods
+	float hypot_checksum = 0.f;
+	auto start = chrono::high_resolution_clock::now();
+	for (const auto &tour : tours)
+	{
+		float distance = HelperFunctions::CalculateInterNodeDistance(depot, problem->GetNodeFromIndex(tour.front()));
+		for (size_t i = 1; i < tour.size(); i++)
+		{
+			distance += HelperFunctions::CalculateInterNodeDistance(problem->GetNodeFromIndex(tour[i - 1]), problem->GetNodeFromIndex(tour[i]));
+		}
+		hypot_checksum += distance + HelperFunctions::CalculateInterNodeDistance(problem->GetNodeFromIndex(tour.back()), depot);
+	}
+	auto end = chrono::high_resolution_clock::now();
+	PrintTiming("Tour distance with hypot()", chrono::duration<double, micro>(end - start).count(), BENCHMARK_TOURS);
+
+	float matrix_checksum = 0.f;
+	start = chrono::high_resolution_clock::now();
+	for (const auto &tour : tours)
+	{
+		float distance = problem->Distance(depot.index, tour.front());
+		for (size_t i = 1; i < tour.size(); i++)
+		{
+			distance += problem->Distance(tour[i - 1], tour[i]);
+		}
+		matrix_checksum += distance + problem->Distance(tour.back(), depot.index);
+	}
+	end = chrono::high_resolution_clock::now();
+	PrintTiming("Tour distance with distance matrix", chrono::duration<double, micro>(end - start).count(), BENCHMARK_TOURS);
+
+	const RouteEvaluator evaluator(*problem);
+	EvaluationScratch scratch(problem);
+	start = chrono::high_resolution_clock::now();
+	for (const auto &tour : tours)
+	{
+		evaluator.Evaluate(tour, scratch);
+	}
+	end = chrono::high_resolution_clock::now();
+	PrintTiming("Full RouteEvaluator evaluation (with the matrix, no hypot() counterpart)", chrono::duration<double, micro>(end - start).count(), BENCHMARK_TOURS);
+
+	cout << "Checksums (should match): " << hypot_checksum << " " << matrix_checksum << endl;
+}
+
+/**
+* Shows how often the charging detours needed by the fitness evaluation are answered from the DetourCache.
+*
+* The same scratch buffer is used for every tour, so the cache warms up over the run the same way it would inside
+* an optimizer. The hit rate is printed for the first and second half of the tours separately.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::ChargingDetours(const ProblemDefinition *problem)
+{
+	const vector<vector<int>> tours = GenerateTours(problem, BENCHMARK_TOURS);
+	const RouteEvaluator evaluator(*problem);
+	EvaluationScratch scratch(problem);
+
+	float total_distance = 0.f;
+	long long previous_hits = 0;
+	long long previous_misses = 0;
+	const auto start = chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < tours.size(); i++)
+	{
+		total_distance += evaluator.Evaluate(tours[i], scratch).distance;
+
+		if (i + 1 == tours.size() / 2 || i + 1 == tours.size())
+		{
+			const long long hits = scratch.detour_cache.GetHits() - previous_hits;
+			const long long misses = scratch.detour_cache.GetMisses() - previous_misses;
+			const double hit_rate = hits + misses > 0 ? 100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+			cout << "Detour cache after " << i + 1 << " tours: " << hits << " hits, " << misses << " misses (" << hit_rate << "% hit rate)" << endl;
+			previous_hits = scratch.detour_cache.GetHits();
+			previous_misses = scratch.detour_cache.GetMisses();
+		}
+	}
+	const auto end = chrono::high_resolution_clock::now();
+	PrintTiming("Evaluation with detour cache", chrono::duration<double, micro>(end - start).count(), BENCHMARK_TOURS);
+	cout << "Average tour distance: " << total_distance / static_cast<float>(tours.size()) << endl;
+}
+
+/**
+* Measures what it costs to select the parents of one generation of the Genetic Algorithm, for populations from
+* #POPULATION_SIZE up to 10,000 solutions.
+*
+* The "copying" timing is how tournament selection used to work: every candidate was copied out of the population
+* into a new SolutionSet, just to take the best one out again. The "index" timing is
+* GeneticAlgorithmOptimizer::TournamentSelection, which only compares distances and returns the row of the winner.
+* Both pick two parents for every child in the generation.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::TournamentSelection(const ProblemDefinition *problem)
+{
+	const int population_sizes[] = {POPULATION_SIZE, 1000, 2000, 5000, 10000};
+	const int largest_population = 10000;
+
+	//one set of evaluated tours is shared by every population size, so only the selection differs between runs
+	const vector<vector<int>> tours = GenerateTours(problem, largest_population);
+	const RouteEvaluator evaluator(*problem);
+	EvaluationScratch scratch(problem);
+	vector<float> distances;
+	distances.reserve(tours.size());
+	for (const auto &tour : tours)
+	{
+		distances.push_back(evaluator.Evaluate(tour, scratch).distance);
+	}
+
+	for (const int population_size : population_sizes)
+	{
+		SolutionSet population;
+		for (int i = 0; i < population_size; i++)
+		{
+			population.AddSolutionToSet({tours[i], distances[i]});
+		}
+		const int selections = 2 * population_size * BENCHMARK_SELECTION_GENERATIONS;
+
+		//the checksums keep the compiler from optimizing the loops away, and should match between both methods
+		RandomGenerator generator(BENCHMARK_SEED, 0);
+		float copying_checksum = 0.f;
+		auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < selections; i++)
+		{
+			SolutionSet tournament_solutions;
+			for (int j = 0; j < max(2, TOURNAMENT_SIZE); j++)
+			{
+				tournament_solutions.AddSolutionToSet(population.GetRandomSolution(generator));
+			}
+			copying_checksum += tournament_solutions.GetBestSolution().distance;
+		}
+		auto end = chrono::high_resolution_clock::now();
+		const double copying_time = chrono::duration<double, milli>(end - start).count() / BENCHMARK_SELECTION_GENERATIONS;
+
+		generator = RandomGenerator(BENCHMARK_SEED, 0);
+		float index_checksum = 0.f;
+		start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < selections; i++)
+		{
+			index_checksum += population.GetDistance(GeneticAlgorithmOptimizer::TournamentSelection(&population, generator));
+		}
+		end = chrono::high_resolution_clock::now();
+		const double index_time = chrono::duration<double, milli>(end - start).count() / BENCHMARK_SELECTION_GENERATIONS;
+
+		cout << "Selection for a population of " << population_size << ": " << copying_time << " ms per generation copying, "
+			<< index_time << " ms per generation by index (checksums " << copying_checksum << " " << index_checksum << ")" << endl;
+	}
+}
+
+/**
+* Compares the cost of drawing a random integer the way the optimizers used to and the way they do now.
+*
+* HelperFunctions::RandomNumberGenerator used to seed a new mt19937 from a random_device on every call, and the
+* workers drew from their own mt19937 through a uniform_int_distribution. RandomGenerator::NextInt replaces both.
+* The per-call seeding is so slow that it only gets a hundredth of the draws.
+*/
+void Benchmark::RandomNumbers()
+{
+	const int reseeded_draws = BENCHMARK_RANDOM_DRAWS / 100;
+	long long reseeded_checksum = 0;
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < reseeded_draws; i++)
+	{
+		random_device rd;
+		mt19937 generator(rd());
+		uniform_int_distribution<> distribution(0, POPULATION_SIZE - 1);
+		reseeded_checksum += distribution(generator);
+	}
+	auto end = chrono::high_resolution_clock::now();
+	PrintTiming("mt19937 seeded from random_device per draw", chrono::duration<double, micro>(end - start).count(), reseeded_draws);
+
+	mt19937 mersenne_twister(BENCHMARK_SEED);
+	long long mersenne_checksum = 0;
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < BENCHMARK_RANDOM_DRAWS; i++)
+	{
+		uniform_int_distribution<> distribution(0, POPULATION_SIZE - 1);
+		mersenne_checksum += distribution(mersenne_twister);
+	}
+	end = chrono::high_resolution_clock::now();
+	PrintTiming("Reused mt19937 with uniform_int_distribution", chrono::duration<double, micro>(end - start).count(), BENCHMARK_RANDOM_DRAWS);
+
+	RandomGenerator xoshiro(BENCHMARK_SEED, 0);
+	long long xoshiro_checksum = 0;
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < BENCHMARK_RANDOM_DRAWS; i++)
+	{
+		xoshiro_checksum += xoshiro.NextInt(0, POPULATION_SIZE - 1);
+	}
+	end = chrono::high_resolution_clock::now();
+	PrintTiming("RandomGenerator::NextInt", chrono::duration<double, micro>(end - start).count(), BENCHMARK_RANDOM_DRAWS);
+
+	cout << "Checksums (should be close to " << (POPULATION_SIZE - 1) / 2.0 << " per draw): "
+		<< static_cast<double>(reseeded_checksum) / reseeded_draws << " "
+		<< static_cast<double>(mersenne_checksum) / BENCHMARK_RANDOM_DRAWS << " "
+		<< static_cast<double>(xoshiro_checksum) / BENCHMARK_RANDOM_DRAWS << endl;
+}
+
+/**
+* Compares the cost of breeding a child with the crossover the Genetic Algorithm used to have against the O(n)
+* crossovers in CrossoverOperators, for tours of 100, 1,000 and 10,000 customers.
+*
+* The problem instances only have up to 100 customers, so the parents are random permutations of 0..n-1 instead
+* of tours of a loaded problem; the crossovers never look at anything but the genes. The "std::find" timing is the
+* old Single Point Crossover, which searched the whole child for every gene of the second parent. It takes O(n^2)
+* time per child, so it only breeds a fraction of the children at the larger tour lengths.
+*/
+void Benchmark::Crossovers()
+{
+	const int tour_lengths[] = {100, 1000, 10000};
+	const CrossoverOperator crossovers[] = {SinglePointCrossover, OrderCrossover, PartiallyMappedCrossover, EdgeRecombinationCrossover};
+
+	for (const int tour_length : tour_lengths)
+	{
+		RandomGenerator generator(BENCHMARK_SEED, 0);
+		vector<vector<int>> parents(BENCHMARK_CROSSOVER_PARENTS, vector<int>(tour_length));
+		for (auto &parent : parents)
+		{
+			iota(parent.begin(), parent.end(), 0);
+			HelperFunctions::ShuffleVector(parent, generator);
+		}
+		const int children = max(1, BENCHMARK_CROSSOVER_GENES / tour_length);
+		vector<int> child(tour_length);
+		cout << "Crossovers of " << tour_length << " customers:" << endl;
+
+		//0 is a gene of the synthetic tours, so the empty slots of the child are marked with -1 instead
+		const int find_children = max(2, children * 100 / tour_length);
+		long long find_checksum = 0;
+		auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < find_children; i++)
+		{
+			const vector<int> &parent_1 = parents[i % BENCHMARK_CROSSOVER_PARENTS];
+			const vector<int> &parent_2 = parents[(i + 1) % BENCHMARK_CROSSOVER_PARENTS];
+			fill(child.begin(), child.end(), -1);
+			const int crossover_point = HelperFunctions::RandomNumberGenerator(0, tour_length, generator);
+			copy_n(parent_1.begin(), crossover_point, child.begin());
+			int child_index = crossover_point;
+			for (const int element : parent_2)
+			{
+				if (find(child.begin(), child.end(), element) == child.end())
+				{
+					child[child_index++] = element;
+				}
+			}
+			find_checksum += child[tour_length / 2];
+		}
+		auto end = chrono::high_resolution_clock::now();
+		PrintTiming("  Single Point with std::find", chrono::duration<double, micro>(end - start).count(), find_children, "crossover");
+
+		CrossoverScratch scratch(tour_length);
+		for (const CrossoverOperator crossover : crossovers)
+		{
+			long long checksum = 0;
+			start = chrono::high_resolution_clock::now();
+			for (int i = 0; i < children; i++)
+			{
+				CrossoverOperators::Apply(crossover, parents[i % BENCHMARK_CROSSOVER_PARENTS].data(), parents[(i + 1) % BENCHMARK_CROSSOVER_PARENTS].data(),
+					tour_length, child.data(), generator, scratch);
+				checksum += child[tour_length / 2];
+			}
+			end = chrono::high_resolution_clock::now();
+			PrintTiming(string("  ") + CrossoverOperators::GetName(crossover), chrono::duration<double, micro>(end - start).count(), children, "crossover");
+
+			//the last child has to be a permutation of the customers, or the timing doesn't mean anything
+			vector<int> sorted_child(child);
+			sort(sorted_child.begin(), sorted_child.end());
+			vector<int> customers(tour_length);
+			iota(customers.begin(), customers.end(), 0);
+			cout << "  (checksum " << checksum << ", last child " << (sorted_child == customers ? "valid" : "INVALID") << ")" << endl;
+		}
+		cout << "  (std::find checksum " << find_checksum << ")" << endl;
+	}
+}
+
+/**
+* Compares the greedy depot returns of RouteEvaluator::Simulate with the optimal ones of RouteEvaluator::Split,
+* on the same tours, for both the distance they find and the time an evaluation takes.
+*
+* Random tours have so many long arcs that where the depot returns go matters a lot, so the comparison is also
+* made on local optima of the LocalSearch (with the greedy split), which are closer to the tours an optimizer works with.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::SplitStrategies(const ProblemDefinition *problem)
+{
+	const vector<pair<SplitStrategy, ChargingStrategy>> strategies = {{GreedySplit, GreedyCharging}, {OptimalSplit, GreedyCharging}};
+	const vector<vector<int>> random_tours = GenerateTours(problem, BENCHMARK_TOURS);
+	CompareStrategies(problem, "Random tours", random_tours, strategies);
+	CompareStrategies(problem, "Local optima", GenerateLocalOptima(problem, random_tours), strategies);
+}
+
+/**
+* Compares the charging detours RouteEvaluator::FindSafePath picks one leg at a time with the charging stops the
+* ChargingPlanner plans for whole routes, on the same tours as SplitStrategies, with the greedy and the optimal split.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::ChargingStrategies(const ProblemDefinition *problem)
+{
+	const vector<pair<SplitStrategy, ChargingStrategy>> strategies = {
+		{GreedySplit, GreedyCharging}, {GreedySplit, OptimalCharging}, {OptimalSplit, GreedyCharging}, {OptimalSplit, OptimalCharging}};
+	const vector<vector<int>> random_tours = GenerateTours(problem, BENCHMARK_TOURS);
+	CompareStrategies(problem, "Random tours", random_tours, strategies);
+	CompareStrategies(problem, "Local optima", GenerateLocalOptima(problem, random_tours), strategies);
+}
+
+/**
+* Compares the LocalSearch that tries every move with the granular one, which only tries the moves that touch the neighbor
+* lists, on instances of 250 and 1,000 customers, where the granular search is the default, see #GRANULAR_SEARCH_MIN_CUSTOMERS.
+*
+* The problem instances only have up to 100 customers, so the instances are synthetic, see GenerateNodes, with the vehicle of the
+* 100 customer instances. Both searches improve the same nearest neighbor tour with at most #BENCHMARK_GRANULAR_MOVES moves, so the
+* timings compare the cost of finding an improving move on a tour where they are rare, and the distances how good the moves each of
+* them finds are. A random tour would flatter the full search, since almost any move improves it.
+*/
+void Benchmark::GranularSearch()
+{
+	const int customer_counts[] = {250, 1000};
+	VehicleParameters vehicle = {};
+	vehicle.load_capacity = 200;
+	vehicle.battery_capacity = 79.69f;
+	vehicle.battery_consumption_rate = 1.f;
+	vehicle.inverse_recharging_rate = 3.39f;
+	vehicle.average_velocity = 1.f;
+
+	for (const int customer_count : customer_counts)
+	{
+		const ProblemDefinition problem(GenerateNodes(customer_count), vehicle);
+		const RouteEvaluator evaluator(problem);
+		//start from a nearest neighbor tour, since it is close enough to a local optimum for improving moves to be rare
+		vector<int> start_tour;
+		vector<bool> visited(problem.GetNodeCount(), false);
+		int current = problem.GetDepotNode().index;
+		for (int i = 0; i < customer_count; i++)
+		{
+			int nearest = -1;
+			for (const auto &customer : problem.GetCustomerNodes())
+			{
+				if (!visited[customer.index] && (nearest == -1 || problem.Distance(current, customer.index) < problem.Distance(current, nearest))) nearest = customer.index;
+			}
+			visited[nearest] = true;
+			start_tour.push_back(nearest);
+			current = nearest;
+		}
+		cout << "Local search on " << customer_count << " synthetic customers:" << endl;
+
+		for (const bool granular : {false, true})
+		{
+			LocalSearch local_search(evaluator);
+			local_search.SetGranular(granular);
+			EvaluationScratch scratch(&problem);
+			LocalSearchScratch search_scratch;
+			solution improved(start_tour);
+
+			const auto start = chrono::high_resolution_clock::now();
+			const int moves = local_search.Improve(improved, scratch, search_scratch, BENCHMARK_GRANULAR_MOVES);
+			const auto end = chrono::high_resolution_clock::now();
+			const double microseconds = chrono::duration<double, micro>(end - start).count();
+
+			cout << "  " << (granular ? "Granular" : "Full") << " search: distance " << improved.distance << " after " << moves << " moves, "
+				<< microseconds / 1000.0 << " ms (" << microseconds / max(1, moves) << " us per move), " << search_scratch.screened_moves
+				<< " moves screened, " << search_scratch.simulated_moves << " simulated" << endl;
+		}
+	}
+}
+
+/**
+* Runs the Genetic Algorithm with and without the RouteCache from the same random seed, and prints the hit rate of the cache
+* averaged over every #BENCHMARK_CACHE_WINDOW generations, next to the time and the best distance of both runs. The hit rate
+* is printed per window instead of for the whole run, so the later generations, where the population has converged, can be
+* told apart from the first ones, where it is still random. The cache doesn't change any evaluation, so both runs have to
+* find the same best distance.
+*
+* @param problem The problem instance to benchmark on
+*/
+void Benchmark::RouteCacheHitRate(const ProblemDefinition *problem)
+{
+	for (const bool cached : {false, true})
+	{
+		GeneticAlgorithmOptimizer genetic_algorithm(problem);
+		genetic_algorithm.SetRandomSeed(BENCHMARK_SEED);
+		if (cached) genetic_algorithm.EnableRouteCache();
+		solution best_solution;
+
+		//the GA prints every generation, which would drown out the results
+		streambuf *console = cout.rdbuf(nullptr);
+		const auto start = chrono::high_resolution_clock::now();
+		genetic_algorithm.Optimize(best_solution);
+		const auto end = chrono::high_resolution_clock::now();
+		cout.rdbuf(console);
+		cout.clear();
+
+		cout << (cached ? "With" : "Without") << " the route cache: best distance " << best_solution.distance << ", "
+			<< chrono::duration<double, milli>(end - start).count() << " ms" << endl;
+
+		const vector<double> &hit_rates = genetic_algorithm.GetRouteCacheHitRates();
+		for (size_t first = 0; first < hit_rates.size(); first += BENCHMARK_CACHE_WINDOW)
+		{
+			const size_t last = min(hit_rates.size(), first + BENCHMARK_CACHE_WINDOW);
+			const double average = accumulate(hit_rates.begin() + first, hit_rates.begin() + last, 0.0) / static_cast<double>(last - first);
+			cout << "  Generations " << first << " to " << last - 1 << ": " << 100.0 * average << "% of the routes found in the cache" << endl;
+		}
+	}
+}
+
+/**
+* Generates the nodes of a synthetic instance, with the depot in the middle of a 100 x 100 square, a 5 x 5 grid of charging
+* stations over it, and customers spread uniformly over it with demands of 1 to 30. The charging stations are close enough to
+* each other that the vehicle of the 100 customer instances can reach every customer. The nodes are the same on every run.
+*
+* @param customer_count The number of customers
+*
+* @return The nodes, with the depot first, followed by the charging stations and the customers
+*/
+vector<Node> Benchmark::GenerateNodes(const int customer_count)
+{
+	RandomGenerator generator(BENCHMARK_SEED, 1);
+	vector<Node> nodes;
+	const auto add_node = [&nodes](const double x, const double y, const int demand, const NodeType type)
+	{
+		Node node = {};
+		node.x = x;
+		node.y = y;
+		node.demand = demand;
+		node.node_type = type;
+		node.isCharger = type == Charger;
+		node.due_date = numeric_limits<float>::max();
+		node.index = static_cast<int>(nodes.size());
+		nodes.push_back(node);
+	};
+
+	add_node(50.0, 50.0, 0, Depot);
+	for (int row = 0; row < 5; row++)
+	{
+		for (int column = 0; column < 5; column++)
+		{
+			add_node(10.0 + 20.0 * column, 10.0 + 20.0 * row, 0, Charger);
+		}
+	}
+	for (int i = 0; i < customer_count; i++)
+	{
+		add_node(generator.NextDouble() * 100.0, generator.NextDouble() * 100.0, HelperFunctions::RandomNumberGenerator(1, 30, generator), Customer);
+	}
+	return nodes;
+}
+
+/**
+* Evaluates every tour with each combination of strategies and prints the average distance, the number of feasible
+* tours and the time per evaluation of each, and how much shorter the tours are than with the first combination.
+*/
+void Benchmark::CompareStrategies(const ProblemDefinition *problem, const string &label, const vector<vector<int>> &tours,
+	const vector<pair<SplitStrategy, ChargingStrategy>> &strategies)
+{
+	const int tour_count = static_cast<int>(tours.size());
+	double baseline_distance = 0.0;
+
+	for (const auto &strategy : strategies)
+	{
+		RouteEvaluator evaluator(*problem);
+		evaluator.SetSplitStrategy(strategy.first);
+		evaluator.SetChargingStrategy(strategy.second);
+		EvaluationScratch scratch(problem);
+
+		double total_distance = 0.0;
+		int feasible_tours = 0;
+		const auto start = chrono::high_resolution_clock::now();
+		for (const auto &tour : tours)
+		{
+			const EvaluationResult result = evaluator.Evaluate(tour, scratch);
+			total_distance += result.distance;
+			feasible_tours += result.feasible ? 1 : 0;
+		}
+		const auto end = chrono::high_resolution_clock::now();
+		const double microseconds = chrono::duration<double, micro>(end - start).count();
+
+		const double average_distance = total_distance / tour_count;
+		if (baseline_distance == 0.0) baseline_distance = average_distance;
+		cout << label << ", " << RouteEvaluator::GetSplitStrategyName(strategy.first) << " split, " << RouteEvaluator::GetChargingStrategyName(strategy.second)
+			<< " charging: average distance " << average_distance << " (" << 100.0 * (1.0 - average_distance / baseline_distance) << "% shorter), "
+			<< feasible_tours << "/" << tour_count << " feasible, " << microseconds / tour_count << " us per evaluation ("
+			<< tour_count / microseconds * 1e6 << " evaluations per second)" << endl;
+
+		const long long created_labels = scratch.charging_planner.GetCreatedLabels();
+		if (created_labels > 0)
+		{
+			cout << "  " << created_labels << " charging labels created, " << 100.0 * static_cast<double>(created_labels - scratch.charging_planner.GetKeptLabels()) / static_cast<double>(created_labels)
+				<< "% of them dominated" << endl;
+		}
+	}
+}
+
+/**
+* Improves the first #BENCHMARK_SPLIT_LOCAL_OPTIMA of the given tours to local optima of the LocalSearch, with the default evaluation.
+*/
+vector<vector<int>> Benchmark::GenerateLocalOptima(const ProblemDefinition *problem, const vector<vector<int>> &tours)
+{
+	const RouteEvaluator evaluator(*problem);
+	const LocalSearch local_search(evaluator);
+	EvaluationScratch scratch(problem);
+	LocalSearchScratch search_scratch;
+	vector<vector<int>> local_optima;
+	for (int i = 0; i < BENCHMARK_SPLIT_LOCAL_OPTIMA && i < static_cast<int>(tours.size()); i++)
+	{
+		solution local_optimum = {tours[i], 0.f};
+		local_search.Improve(local_optimum, scratch, search_scratch);
+		local_optima.push_back(local_optimum.tour);
+	}
+	return local_optima;
+}
+
+/**
+* Generates a reproducible set of random customer tours for the benchmarks.
+*
+* @param problem The problem instance to generate the tours for
+* @param count The number of tours to generate
+*
+* @return #count random permutations of the customer nodes
+*/
+vector<vector<int>> Benchmark::GenerateTours(const ProblemDefinition *problem, const int count)
+{
+	RandomGenerator generator(BENCHMARK_SEED, 0);
+	vector<vector<int>> tours;
+	tours.reserve(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		tours.push_back(problem->GenerateRandomTour(generator));
+	}
+	return tours;
+}
+
+void Benchmark::PrintTiming(const string &label, const double total_microseconds, const int count, const string &unit)
+{
+	cout << label << ": " << total_microseconds / count << " us per " << unit << " (" << count << " " << unit << "s)" << endl;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "ProblemDefinition.h"
+#include "RouteEvaluator.h"
+
+constexpr int BENCHMARK_TOURS = 1000; /*!< Number of random tours each benchmark evaluates */
+constexpr unsigned BENCHMARK_SEED = 12345; /*!< Fixed seed so every benchmark run measures the same tours */
+constexpr int BENCHMARK_RANDOM_DRAWS = 1000000; /*!< Number of random numbers drawn from each of the fast generators */
+constexpr int BENCHMARK_SELECTION_GENERATIONS = 10; /*!< Number of generations worth of parent selections timed for each population size */
+constexpr int BENCHMARK_CROSSOVER_GENES = 2000000; /*!< Number of genes bred by each crossover for each tour length, spread over as many children as that takes */
+constexpr int BENCHMARK_CROSSOVER_PARENTS = 16; /*!< Number of synthetic parent tours the crossovers pick their parents from */
+constexpr int BENCHMARK_GRANULAR_MOVES = 200; /*!< Number of moves the full and the granular local search make on the synthetic instances, the full search takes minutes to reach a local optimum of the larger instance */
+constexpr int BENCHMARK_CACHE_WINDOW = 100; /*!< Number of generations the route cache hit rate is averaged over */
+constexpr int BENCHMARK_SPLIT_LOCAL_OPTIMA = 20; /*!< Number of random tours improved to a local optimum for the split benchmark, since random tours alone overstate what a better split is worth */
+
+/***************************************************************************//**
+ * Microbenchmarks for the hot paths of the fitness evaluation and the optimizers.
+ *
+ * Each benchmark prints its timings to the console. They are run from the Benchmark
+ * RunState in EVRPOptimization.cpp through EVRP_Solver::BenchmarkEVRP, so they use the
+ * exact same problem loading as the optimizers do.
+ ******************************************************************************/
+class Benchmark
+{
+public:
+	static void DistanceMatrix(const ProblemDefinition *problem);
+	static void ChargingDetours(const ProblemDefinition *problem);
+	static void TournamentSelection(const ProblemDefinition *problem);
+	static void RandomNumbers();
+	static void Crossovers();
+	static void SplitStrategies(const ProblemDefinition *problem);
+	static void ChargingStrategies(const ProblemDefinition *problem);
+	static void GranularSearch();
+	static void RouteCacheHitRate(const ProblemDefinition *problem);
+
+private:
+	static vector<vector<int>> GenerateTours(const ProblemDefinition *problem, int count);
+	static void CompareStrategies(const ProblemDefinition *problem, const string &label, const vector<vector<int>> &tours,
+		const vector<pair<SplitStrategy, ChargingStrategy>> &strategies);
+	static vector<vector<int>> GenerateLocalOptima(const ProblemDefinition *problem, const vector<vector<int>> &tours);
+	static vector<Node> GenerateNodes(int customer_count);
+	static void PrintTiming(const string &label, double total_microseconds, int count, const string &unit = "evaluation");
+};
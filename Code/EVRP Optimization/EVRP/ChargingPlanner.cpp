@@ -0,0 +1,183 @@
+#include "ChargingPlanner.h"
+
+#include <algorithm>
+#include <limits>
+
+ChargingPlanner::ChargingPlanner(const ProblemDefinition *problem) : problem_definition(problem)
+{
+	const VehicleParameters &params = problem->GetVehicleParameters();
+	max_battery = params.battery_capacity;
+	battery_consumption_rate = params.battery_consumption_rate;
+	charger_count = static_cast<int>(problem->GetChargingNodes().size());
+	exit_distance.resize(charger_count);
+	StartRoute();
+}
+
+/**
+* Starts a new route at the depot, with nothing driven yet and a full battery.
+*/
+void ChargingPlanner::StartRoute()
+{
+	labels.assign(1, {0.f, max_battery});
+	reach_from = -1;
+}
+
+/**
+* Drives on from the last node of the route to the next one, see ChargingPlanner.
+*
+* @param from The index of the last node of the route
+* @param to The index of the node to drive to next
+*
+* @return False if the vehicle can't get there in any way, in which case the route is left as it was
+*/
+bool ChargingPlanner::Extend(const int from, const int to)
+{
+	const float leg_distance = problem_definition->Distance(from, to);
+	const float leg_battery = leg_distance * battery_consumption_rate;
+
+	candidates.clear();
+	for (const auto &label : labels)
+	{
+		if (label.battery >= leg_battery) candidates.push_back({label.distance + leg_distance, label.battery - leg_battery});
+	}
+
+	//a label that comes through a charger has driven at least to the nearest charger and from the nearest charger to the next
+	//node, and has at most the battery left that the last of those legs leaves, so a direct label that beats both dominates all of them
+	FindReachableChargers(from);
+	const int nearest_charger = problem_definition->GetNearestCharger(to);
+	bool chargers_dominated = reaching_labels.empty() || nearest_charger == -1;
+	if (!chargers_dominated)
+	{
+		const float exit_leg = problem_definition->Distance(nearest_charger, to);
+		const ChargingLabel bound = {shortest_reach + exit_leg, max_battery - exit_leg * battery_consumption_rate};
+		for (const auto &candidate : candidates)
+		{
+			if (candidate.distance <= bound.distance && candidate.battery >= bound.battery) chargers_dominated = true;
+		}
+	}
+
+	if (!chargers_dominated)
+	{
+		FindChargerExits();
+		const vector<Node> &chargers = problem_definition->GetChargingNodes();
+		for (int last = 0; last < charger_count; last++)
+		{
+			if (exit_distance[last] == numeric_limits<float>::max()) continue;
+			const float exit_leg = problem_definition->Distance(chargers[last].index, to);
+			if (exit_leg * battery_consumption_rate > max_battery) continue;
+			candidates.push_back({exit_distance[last] + exit_leg, max_battery - exit_leg * battery_consumption_rate});
+		}
+	}
+	if (candidates.empty()) return false;
+
+	//sorted by distance, a label is only worth keeping if it has more battery left than every shorter one
+	sort(candidates.begin(), candidates.end(), [](const ChargingLabel &a, const ChargingLabel &b)
+	{
+		return a.distance < b.distance || (a.distance == b.distance && a.battery > b.battery);
+	});
+	labels.clear();
+	for (const auto &candidate : candidates)
+	{
+		if (labels.empty() || candidate.battery > labels.back().battery) labels.push_back(candidate);
+	}
+	created_labels += static_cast<long long>(candidates.size());
+	kept_labels += static_cast<long long>(labels.size());
+	reach_from = -1;
+	return true;
+}
+
+/**
+* The shortest distance the route can end with if it drives from its last node to another one, such as back to
+* the depot, without changing the route.
+*
+* @param from The index of the last node of the route
+* @param to The index of the node to drive to
+*
+* @return The distance of the whole route, or infinity if the vehicle can't get there
+*/
+float ChargingPlanner::DistanceTo(const int from, const int to)
+{
+	const float leg_distance = problem_definition->Distance(from, to);
+	const float leg_battery = leg_distance * battery_consumption_rate;
+
+	//the labels are sorted by distance, so the first one with the battery for the leg is the best direct way
+	float best = numeric_limits<float>::infinity();
+	for (const auto &label : labels)
+	{
+		if (label.battery >= leg_battery)
+		{
+			best = label.distance + leg_distance;
+			break;
+		}
+	}
+
+	//every way through the chargers is at least as long as through the nearest ones
+	FindReachableChargers(from);
+	const int nearest_charger = problem_definition->GetNearestCharger(to);
+	if (reaching_labels.empty() || nearest_charger == -1 || shortest_reach + problem_definition->Distance(nearest_charger, to) >= best) return best;
+
+	FindChargerExits();
+	const vector<Node> &chargers = problem_definition->GetChargingNodes();
+	for (int last = 0; last < charger_count; last++)
+	{
+		if (exit_distance[last] >= best) continue;
+		const float exit_leg = problem_definition->Distance(chargers[last].index, to);
+		if (exit_leg * battery_consumption_rate > max_battery) continue;
+		best = min(best, exit_distance[last] + exit_leg);
+	}
+	return best;
+}
+
+/**
+* Finds how many of the closest charging stations each label can drive to directly.
+*
+* The labels are sorted by distance with the battery increasing, and the charging stations by the battery it takes to
+* get to them, so this takes one pass over both. A label that can't reach more stations than a shorter one can't lead
+* to a shorter way through the charger graph either, so only the labels that reach more stations than all shorter ones are kept.
+*/
+void ChargingPlanner::FindReachableChargers(const int from)
+{
+	if (reach_from == from) return;
+	reach_from = from;
+	exits_found = false;
+
+	const vector<Node> &chargers = problem_definition->GetChargingNodes();
+	const int *by_distance = problem_definition->GetChargersByDistance(from);
+	reaching_labels.clear();
+	int in_range = 0;
+	for (const auto &label : labels)
+	{
+		const int previous_in_range = in_range;
+		while (in_range < charger_count && problem_definition->Distance(from, chargers[by_distance[in_range]].index) * battery_consumption_rate <= label.battery)
+		{
+			in_range++;
+		}
+		if (in_range > previous_in_range) reaching_labels.push_back({label.distance, in_range});
+		if (in_range == charger_count) break;
+	}
+
+	shortest_reach = reaching_labels.empty() ? numeric_limits<float>::max()
+		: reaching_labels.front().distance + problem_definition->Distance(from, chargers[by_distance[0]].index);
+}
+
+/**
+* Finds the shortest distance at which the current labels can leave every charging station with a full battery.
+* The distances through the charger graph for every number of stations in range are precomputed by
+* ProblemDefinition::GetChargerDistancesInRange, so this only takes a pass over the stations per label that FindReachableChargers kept.
+*/
+void ChargingPlanner::FindChargerExits()
+{
+	if (exits_found) return;
+	exits_found = true;
+
+	fill(exit_distance.begin(), exit_distance.end(), numeric_limits<float>::max());
+	for (const auto &reaching : reaching_labels)
+	{
+		const float *in_range_distance = problem_definition->GetChargerDistancesInRange(reach_from, reaching.in_range);
+		for (int last = 0; last < charger_count; last++)
+		{
+			if (in_range_distance[last] == numeric_limits<float>::max()) continue;
+			exit_distance[last] = min(exit_distance[last], reaching.distance + in_range_distance[last]);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "ProblemDefinition.h"
+
+/**
+* One way the vehicle can have gotten to the node it is at: the distance it drove on the current route,
+* and the battery it has left.
+*/
+struct ChargingLabel
+{
+	float distance;
+	float battery;
+};
+
+/***************************************************************************//**
+ * Finds the shortest way to drive a route through a fixed sequence of customers, with
+ * charging stops inserted wherever they make the whole route shortest.
+ *
+ * Detouring to the charger that is best for the next leg, like FindChargingDetour does,
+ * can leave the vehicle with too little battery for the legs after that, or make it skip
+ * a charger right next to the route that would have saved a detour later. Instead the
+ * planner keeps a set of labels at the last customer of the route, one for every
+ * trade-off between the distance driven and the battery left that could still turn
+ * out to be best. Each leg to the next customer extends every label in two ways:
+ *
+ * - driving there directly, if the battery is enough to arrive, and
+ * - driving to a first charging station in range, along the shortest path through the
+ *   charger graph to a last charging station, and from there to the customer with a
+ *   full battery.
+ *
+ * The charging stations in range of a label are a prefix of the stations sorted by distance
+ * (ProblemDefinition::GetChargersByDistance), and the shortest paths through the charger graph
+ * for every length of that prefix are precomputed (ProblemDefinition::GetChargerDistancesInRange),
+ * so a leg only costs a pass over the labels and a pass over the stations for each label that can
+ * reach more of them than the shorter labels. Even that is skipped when a label that drives directly
+ * already dominates every label that could come through a charger. A leg visits chargers at most once between two
+ * customers, through the charger graph, and a vehicle that arrives through a charger always arrives
+ * with the same battery no matter where it came from, so at most one label per last charger survives.
+ * A label is dropped as soon as another one has driven no further and has at least as much battery left,
+ * which keeps the sets small.
+ *
+ * The planner is not thread safe, so every thread evaluating tours needs its own, see EvaluationScratch.
+ ******************************************************************************/
+class ChargingPlanner
+{
+public:
+	explicit ChargingPlanner(const ProblemDefinition *problem);
+
+	void StartRoute();
+	bool Extend(int from, int to);
+	float DistanceTo(int from, int to);
+
+	/** The shortest distance any label has driven on the current route, a lower bound on the distance of the whole route */
+	float GetShortestDistance() const { return labels.front().distance; }
+
+	long long GetCreatedLabels() const { return created_labels; }
+	long long GetKeptLabels() const { return kept_labels; }
+
+private:
+	void FindReachableChargers(int from);
+	void FindChargerExits();
+
+	const ProblemDefinition *problem_definition;
+	float max_battery;
+	float battery_consumption_rate;
+	int charger_count;
+
+	vector<ChargingLabel> labels; /*!< The labels at the last node of the route, sorted by distance with the battery strictly increasing*/
+	vector<ChargingLabel> candidates; /*!< The labels at the next node before the dominated ones are dropped*/
+	/** A label that can drive directly to the in_range closest charging stations, and no shorter label can reach as many */
+	struct ReachingLabel
+	{
+		float distance;
+		int in_range;
+	};
+
+	vector<ReachingLabel> reaching_labels; /*!< The labels worth going to a charging station from, see FindReachableChargers*/
+	float shortest_reach = 0.f; /*!< The shortest distance at which any label can get to a charging station*/
+	vector<float> exit_distance; /*!< For every charging station, the shortest distance at which a label can leave it with a full battery*/
+	int reach_from = -1; /*!< The node #reaching_labels was found for with the current labels, or -1, since DistanceTo and Extend from the same node share it*/
+	bool exits_found = false; /*!< Whether #exit_distance belongs to #reaching_labels*/
+
+	long long created_labels = 0;
+	long long kept_labels = 0;
+};
@@ -0,0 +1,58 @@
+#include "DetourCache.h"
+
+#include <algorithm>
+
+/**
+* Looks up the shortest charging detour from start to end, computing and caching it on a miss.
+*
+* @param start The index of the node the vehicle is at
+* @param end The index of the node the vehicle wants to get to
+* @param battery_level The battery the vehicle has when leaving start
+*
+* @return The indices of the charging stations to visit in order, or nullptr if there is no feasible detour.
+* The pointer is only valid until the next call.
+*/
+const vector<int> *DetourCache::FindDetour(const int start, const int end, const float battery_level)
+{
+	const int in_range = CountChargersInRange(start, battery_level);
+	const uint64_t node_count = problem_definition->GetNodeCount();
+	const uint64_t key = (static_cast<uint64_t>(start) * node_count + end) * (charger_count + 1) + in_range;
+
+	auto it = detours.find(key);
+	if (it != detours.end())
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+		if (detours.size() >= DETOUR_CACHE_CAPACITY) detours.clear();
+
+		vector<int> chargers;
+		problem_definition->FindChargingDetour(start, end, battery_level, chargers);
+		it = detours.emplace(key, std::move(chargers)).first;
+	}
+
+	return it->second.empty() ? nullptr : &it->second;
+}
+
+/**
+* The number of charging stations a vehicle can drive to directly from start, which are the closest ones
+* of GetChargersByDistance, so they are found with a binary search.
+*/
+int DetourCache::CountChargersInRange(const int start, const float battery_level) const
+{
+	const vector<Node> &chargers = problem_definition->GetChargingNodes();
+	const int *by_distance = problem_definition->GetChargersByDistance(start);
+	return static_cast<int>(partition_point(by_distance, by_distance + charger_count, [&](const int charger)
+	{
+		return problem_definition->Distance(start, chargers[charger].index) * battery_consumption_rate <= battery_level;
+	}) - by_distance);
+}
+
+void DetourCache::Clear()
+{
+	detours.clear();
+	hits = 0;
+	misses = 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+
+#include "ProblemDefinition.h"
+
+constexpr size_t DETOUR_CACHE_CAPACITY = 1 << 18; /*!< Number of detours a DetourCache holds before it starts over, so it can't grow without bound */
+
+/***************************************************************************//**
+ * Memoizes ProblemDefinition::FindChargingDetour.
+ *
+ * The shortest detour only depends on the battery level through which charging stations
+ * are in range of the start node, and those are always the closest few of them
+ * (ProblemDefinition::GetChargersByDistance). Detours are keyed by their start node, end
+ * node and the number of charging stations in range, so every cached detour is exactly
+ * the one FindChargingDetour would find for the battery level asked about.
+ *
+ * Once the cache holds #DETOUR_CACHE_CAPACITY detours it is emptied and fills up again
+ * with the detours that are still being asked for.
+ *
+ * The cache is not thread safe, so every thread evaluating tours needs its own.
+ ******************************************************************************/
+class DetourCache
+{
+public:
+	explicit DetourCache(const ProblemDefinition *problem) : problem_definition(problem)
+	{
+		battery_consumption_rate = problem->GetVehicleParameters().battery_consumption_rate;
+		charger_count = static_cast<int>(problem->GetChargingNodes().size());
+	}
+
+	const vector<int> *FindDetour(int start, int end, float battery_level);
+	void Clear();
+
+	long long GetHits() const { return hits; }
+	long long GetMisses() const { return misses; }
+
+private:
+	int CountChargersInRange(int start, float battery_level) const;
+
+	const ProblemDefinition *problem_definition;
+	float battery_consumption_rate;
+	int charger_count;
+
+	unordered_map<uint64_t, vector<int>> detours; /*!< Cached charging station sequences, empty if no detour is feasible */
+
+	long long hits = 0;
+	long long misses = 0;
+};
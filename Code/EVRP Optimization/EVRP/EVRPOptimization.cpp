@@ -34,8 +34,11 @@
 */
 
 #include <iostream>
+#include <random>
 #include <thread>
 #include "EVRP_Solver.h"
+#include "RandomGenerator.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
@@ -78,10 +81,30 @@ enum RunState
     Standard_Test,
     Standard_Full,
     Seeded_Test,
-    Seeded_Full
+    Seeded_Full,
+    Island_Full,
+    Memetic_Full,
+    Benchmark,
+    Split_Benchmark
 };
 constexpr RunState State = Debug;
 
+constexpr CrossoverOperator CROSSOVER = SinglePointCrossover; /*!< Crossover the Genetic Algorithm breeds its children with in every RunState, see CrossoverOperators*/
+constexpr int GRANULAR_CUSTOMERS = GRANULAR_SEARCH_MIN_CUSTOMERS; /*!< The local search only tries the moves that touch the neighbor lists on instances with at least this many customers, 0 always does*/
+constexpr size_t ROUTE_CACHE_CAPACITY = DEFAULT_ROUTE_CACHE_CAPACITY; /*!< Number of routes the Genetic Algorithm memoizes in every RunState, see RouteCache. 0 turns the cache off*/
+constexpr uint64_t RANDOM_SEED = 0; /*!< Seed that every random number stream of the run is derived from. 0 picks a new seed every run, set it to the seed printed by an earlier run to replay that run*/
+
+
+/**
+ * \brief Applies the options above that every RunState shares to a freshly loaded solver.
+ * \param solver The solver to configure
+ */
+void ConfigureSolver(EVRP_Solver *solver)
+{
+    solver->SetCrossoverOperator(CROSSOVER);
+    solver->SetGranularSearchMinCustomers(GRANULAR_CUSTOMERS);
+    solver->SetRouteCacheCapacity(ROUTE_CACHE_CAPACITY);
+}
 
 /**
  * \brief 
@@ -98,9 +121,13 @@ void StandardSolve(const vector<string> &files, int num_threads, void(EVRP_Solve
     {
         //create EVRP_Solver instance and read the file
         //EVRP_Solver::IsGoodOpen() is false if the constructor failed to read the file
-        const auto *solver = new EVRP_Solver(file);
+        auto *solver = new EVRP_Solver(file);
         if(solver->IsGoodOpen())
         {
+            //the solver threads share the hardware threads, so the algorithms that run on a thread pool don't oversubscribe the machine
+            solver->SetWorkerCount(max(1, ThreadPool::DefaultWorkerCount() / num_threads));
+            ConfigureSolver(solver);
+
             //What time is it before solving the problem
             const auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -137,7 +164,8 @@ void SeedSolve(const vector<string> &files, int num_threads, EVRP_Solver::SeedAl
 {
     for(const auto &file : files)
     {
-        const auto* solver = new EVRP_Solver(file);
+        auto* solver = new EVRP_Solver(file);
+        ConfigureSolver(solver);
         solver->SolveEVRP_Seed(alg);
     }
 }
@@ -155,6 +183,9 @@ void SeedSolve(const vector<string> &files, int num_threads, EVRP_Solver::SeedAl
  ******************************************************************************/
 int main()
 {
+    RandomGenerator::SetRunSeed(RANDOM_SEED != 0 ? RANDOM_SEED : random_device{}());
+    cout << "Random seed for this run: " << RandomGenerator::GetRunSeed() << endl;
+
     //list of files to run our tests on
     const vector<string> test_files = { "rc103c15.txt" };
 
@@ -172,12 +203,29 @@ int main()
         //unique one hundred customer problems
         "c101_21.txt", "c201_21.txt", "r101_21.txt", "r201_21.txt", "rc101_21.txt", "rc201_21.txt", 
    };
+
+    //the benchmarks only care about the larger instances, since that is where evaluation cost matters
+    const vector<string> benchmark_files = {
+        "c103C15.txt", "c202C15.txt", "r102C15.txt", "r202C15.txt", "rc103C15.txt", "rc202C15.txt", 
+        "c101_21.txt", "c201_21.txt", "r101_21.txt", "r201_21.txt", "rc101_21.txt", "rc201_21.txt", 
+    };
+
+    //every one hundred customer problem, since how much a better split is worth depends on the instance
+    const vector<string> split_benchmark_files = {
+        "c101_21.txt", "c102_21.txt", "c103_21.txt", "c104_21.txt", "c105_21.txt", "c106_21.txt", "c107_21.txt", "c108_21.txt", "c109_21.txt", 
+        "c201_21.txt", "c202_21.txt", "c203_21.txt", "c204_21.txt", "c205_21.txt", "c206_21.txt", "c207_21.txt", "c208_21.txt", 
+        "r101_21.txt", "r102_21.txt", "r103_21.txt", "r104_21.txt", "r105_21.txt", "r106_21.txt", "r107_21.txt", "r108_21.txt", "r109_21.txt", "r110_21.txt", "r111_21.txt", "r112_21.txt", 
+        "r201_21.txt", "r202_21.txt", "r203_21.txt", "r204_21.txt", "r205_21.txt", "r206_21.txt", "r207_21.txt", "r208_21.txt", "r209_21.txt", "r210_21.txt", "r211_21.txt", 
+        "rc101_21.txt", "rc102_21.txt", "rc103_21.txt", "rc104_21.txt", "rc105_21.txt", "rc106_21.txt", "rc107_21.txt", "rc108_21.txt", 
+        "rc201_21.txt", "rc202_21.txt", "rc203_21.txt", "rc204_21.txt", "rc205_21.txt", "rc206_21.txt", "rc207_21.txt", "rc208_21.txt", 
+    };
     
     switch(State)
     {
     case Debug:
         {
-            const auto *solver = new EVRP_Solver("c103c5.txt");
+            auto *solver = new EVRP_Solver("c103c5.txt");
+            ConfigureSolver(solver);
             if(solver->IsGoodOpen()) solver->DebugEVRP();
             break;
         }
@@ -196,6 +244,23 @@ int main()
         
     case Seeded_Full:
         break;
+
+    case Island_Full:
+        //one solve at a time, since the island model already uses every hardware thread
+        StandardSolve(full_files, 1, &EVRP_Solver::SolveEVRP_Islands);
+        break;
+
+    case Memetic_Full:
+        StandardSolve(full_files, 1, &EVRP_Solver::SolveEVRP_Memetic);
+        break;
+
+    case Benchmark:
+        StandardSolve(benchmark_files, 1, &EVRP_Solver::BenchmarkEVRP);
+        break;
+
+    case Split_Benchmark:
+        StandardSolve(split_benchmark_files, 1, &EVRP_Solver::BenchmarkSplitEVRP);
+        break;
         
     }
     return 0;
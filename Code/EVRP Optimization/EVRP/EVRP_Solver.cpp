@@ -1,17 +1,23 @@
 #include "EVRP_Solver.h"
 
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <mutex>
 #include <iostream>
 #include <sstream>
 
 #include "ProblemDefinition.h"
+#include "Benchmark.h"
 #include "HelperFunctions.h"
 #include "SolutionSet.h"
 #include "Algorithms/GA/GeneticAlgorithmOptimizer.h"
 #include "Algorithms/NEH/NEH_NearestNeighbor.h"
+#include "ThreadPool.h"
 #include "Algorithms/RandomSearch/RandomSearchOptimizer.h"
+#include "Algorithms/Savings/SavingsOptimizer.h"
+#include "Algorithms/ALNS/ALNSOptimizer.h"
+#include "Algorithms/LocalSearch/LocalSearchOptimizer.h"
 
 
 mutex file_write_mutex_;
@@ -142,20 +148,63 @@ void EVRP_Solver::DebugEVRP() const
 {
 	
 	auto *alg = new GeneticAlgorithmOptimizer(problem_definition);
+	ConfigureGA(alg);
 	solution s = {};
 	alg->Optimize(s);
 
-	HelperFunctions::PrintTour(HelperFunctions::GetIndexEncodedTour(s.tour));
+	HelperFunctions::PrintTour(s.tour);
 	cout << "Best tour has a distance of: " << s.distance << endl;
 	
 	/*
-	auto *vehicle = new Vehicle(problem_definition);
+	const RouteEvaluator evaluator(*problem_definition);
+	EvaluationScratch scratch(problem_definition);
 	const vector<int> test_route = {7, 8, 4, 5, 6};
-	const float result = vehicle->SimulateDrive(HelperFunctions::GetNodeDecodedTour(problem_definition, test_route), true);
+	const float result = evaluator.Evaluate(test_route, scratch, true).distance;
 	cout << "Best tour has a distance of: " << result << endl;
 	*/
 }
 
+/**
+ * \brief Runs the microbenchmarks on the loaded problem instance.
+ * Nothing is written to the output file, the timings are only printed to the console.
+ */
+void EVRP_Solver::BenchmarkEVRP() const
+{
+	cout << "=== Distance matrix benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::DistanceMatrix(problem_definition);
+
+	cout << "=== Charging detour benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::ChargingDetours(problem_definition);
+
+	cout << "=== Tournament selection benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::TournamentSelection(problem_definition);
+
+	cout << "=== Random number benchmark ===" << endl;
+	Benchmark::RandomNumbers();
+
+	cout << "=== Crossover benchmark ===" << endl;
+	Benchmark::Crossovers();
+
+	cout << "=== Charging strategy benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::ChargingStrategies(problem_definition);
+
+	cout << "=== Granular local search benchmark ===" << endl;
+	Benchmark::GranularSearch();
+
+	cout << "=== Route cache benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::RouteCacheHitRate(problem_definition);
+}
+
+/**
+ * \brief Compares the greedy and the optimal split of tours into routes on the loaded problem instance, see Benchmark::SplitStrategies.
+ * This has its own RunState, since it is meant to be run on every instance instead of just the benchmark files.
+ */
+void EVRP_Solver::BenchmarkSplitEVRP() const
+{
+	cout << "=== Split benchmark for " << _current_filename << " ===" << endl;
+	Benchmark::SplitStrategies(problem_definition);
+}
+
 /***************************************************************************//**
  * \brief SolveEVRP is where the choice of algorithm occurs. 
  *
@@ -177,54 +226,104 @@ void EVRP_Solver::SolveEVRP() const
 	
 	for(const auto alg : algorithms)
 	{
-		cout << "Calculating standard solve for " << alg->GetName() << "!" << endl;
-		
-		solution best_solution = {};
-		
-		//What time is it before solving the problem
-		//const auto start_time = std::chrono::high_resolution_clock::now();
-		HANDLE thread = GetCurrentThread();
-		ULARGE_INTEGER start = get_thread_CPU_time(thread);
-
-		//Function call to the GeneticAlgorithmOptimizer class that will return the best tour
-		//from the given data
-		alg->Optimize(best_solution);
-
-		//What time is it now that we've solved the problem
-		ULARGE_INTEGER end = get_thread_CPU_time(thread);
-		//const auto end_time = chrono::high_resolution_clock::now();
-		
-		//Get the execution time in milliseconds 
-		const double duration = static_cast<double>(end.QuadPart - start.QuadPart) / 10000;
+		RunAlgorithm(alg);
+	}
+}
 
-		//const auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
-		//const auto duration = static_cast<double>(end.QuadPart - start.QuadPart) * 1e-7;
-		//const auto duration = 0.f;
-		
-		//cout << "Execution time of algorithm " << alg->GetName() << ": " << static_cast<float>(duration)/1000.0f << " seconds" << endl;
-		//cout << "The best route has a distance of: " << best_distance << endl;
+/**
+ * \brief Solves the problem with the island model GA, with one island per worker thread.
+ * The islands cooperate by migrating their best solutions, so unlike launching one SolveEVRP per
+ * thread, this produces a single result that benefits from every thread's work.
+ */
+void EVRP_Solver::SolveEVRP_Islands() const
+{
+	auto *alg = new GeneticAlgorithmOptimizer(problem_definition);
+	ConfigureGA(alg);
+	alg->SetIslandModel(worker_count > 0 ? worker_count : ThreadPool::DefaultWorkerCount());
+	RunAlgorithm(alg);
+}
 
-		for (const auto& index : best_solution.tour)
-		{
-			int index_count = 0;
-			for (const auto& i : best_solution.tour)
-			{
-				if (index == i) index_count++;
-			}
-			assert(index_count == 1);
-		}
+/**
+ * \brief Solves the problem with the memetic GA, which improves #MEMETIC_RATE of its children with a few
+ * LocalSearch moves each, see GeneticAlgorithmOptimizer::SetLocalSearch.
+ */
+void EVRP_Solver::SolveEVRP_Memetic() const
+{
+	auto *alg = new GeneticAlgorithmOptimizer(problem_definition);
+	ConfigureGA(alg);
+	alg->SetLocalSearch(MEMETIC_RATE);
+	RunAlgorithm(alg);
+}
 
-		optimization_result result;
-		result.algorithm_name = alg->GetName();
-		result.execution_time = static_cast<float>(duration) / 1000.0f;
-		result.solution_encoded = HelperFunctions::GetIndexEncodedTour(best_solution.tour);
-		result.distance = best_solution.distance;
-		result.hyperparameters = alg->GetHyperParameters();
+/**
+ * \brief Applies the Genetic Algorithm options of this solver, so every solve path runs the GA the same way.
+ * \param alg The Genetic Algorithm to configure, before it is optimized
+ */
+void EVRP_Solver::ConfigureGA(GeneticAlgorithmOptimizer *alg) const
+{
+	alg->SetCrossoverOperator(crossover_operator);
+	alg->SetGranularSearch(UseGranularSearch());
+	if (route_cache_capacity > 0) alg->EnableRouteCache(route_cache_capacity);
+}
+
+/**
+ * \brief Whether the local searches of this solver only try the moves that touch the neighbor lists on the loaded problem, see SetGranularSearchMinCustomers.
+ */
+bool EVRP_Solver::UseGranularSearch() const
+{
+	return static_cast<int>(problem_definition->GetCustomerNodes().size()) >= granular_min_customers;
+}
+
+/**
+ * \brief Runs a single algorithm on the problem, times it and writes the result to the output file.
+ * The time is wall-clock time, since the algorithms that run on a ThreadPool spread their work over several threads,
+ * and the CPU time of the calling thread would only count its own share. The worker count is logged next to it.
+ * \param alg The algorithm to run
+ */
+void EVRP_Solver::RunAlgorithm(AlgorithmBase *alg) const
+{
+	cout << "Calculating standard solve for " << alg->GetName() << "!" << endl;
+	
+	solution best_solution = {};
+	alg->SetWorkerCount(worker_count);
+	
+	//What time is it before solving the problem
+	const auto start_time = chrono::steady_clock::now();
+
+	//Function call to the GeneticAlgorithmOptimizer class that will return the best tour
+	//from the given data
+	alg->Optimize(best_solution);
+
+	//What time is it now that we've solved the problem
+	const auto end_time = chrono::steady_clock::now();
+	
+	//Get the execution time in milliseconds 
+	const double duration = chrono::duration<double, milli>(end_time - start_time).count();
+	
+	//cout << "Execution time of algorithm " << alg->GetName() << ": " << static_cast<float>(duration)/1000.0f << " seconds" << endl;
+	//cout << "The best route has a distance of: " << best_distance << endl;
 
-		unique_lock<mutex> lock(file_write_mutex_);
-		WriteToFile(result);
-		lock.unlock();
+	for (const auto& index : best_solution.tour)
+	{
+		int index_count = 0;
+		for (const auto& i : best_solution.tour)
+		{
+			if (index == i) index_count++;
+		}
+		assert(index_count == 1);
 	}
+
+	optimization_result result;
+	result.algorithm_name = alg->GetName();
+	result.execution_time = static_cast<float>(duration) / 1000.0f;
+	result.worker_count = alg->GetWorkerCount();
+	result.solution_encoded = best_solution.tour;
+	result.distance = best_solution.distance;
+	result.hyperparameters = alg->GetHyperParameters();
+
+	unique_lock<mutex> lock(file_write_mutex_);
+	WriteToFile(result);
+	lock.unlock();
 }
 
 void EVRP_Solver::SolveEVRP_Seed(SeedAlgorithm seed) const
@@ -234,13 +333,37 @@ void EVRP_Solver::SolveEVRP_Seed(SeedAlgorithm seed) const
 	switch(seed)
 	{
 	case NEH:
-		seed_solver = new NEH_NearestNeighbor(problem_definition);
+	{
+		//every ordering NEH tries gives the GA another good seed
+		const auto neh_solver = new NEH_NearestNeighbor(problem_definition);
+		neh_solver->SetMultiStart();
+		seed_solver = neh_solver;
 		break;
+	}
 	case RNG:
-		seed_solver = new RandomSearchOptimizer(problem_definition);
+	{
+		//only the best of every generation seeds the GA, so a larger budget costs time but no memory
+		const auto random_search_solver = new RandomSearchOptimizer(problem_definition);
+		random_search_solver->SetSampleBudget(NUM_GENERATIONS, SEED_SAMPLE_MULTIPLIER * SOLUTIONS_PER_GENERATION);
+		seed_solver = random_search_solver;
+		break;
+	}
+	case Savings:
+		seed_solver = new SavingsOptimizer(problem_definition);
+		break;
+	case ALNS:
+		seed_solver = new ALNSOptimizer(problem_definition);
+		break;
+	case LocalOptima:
+	{
+		const auto local_search_solver = new LocalSearchOptimizer(problem_definition);
+		local_search_solver->SetGranularSearch(UseGranularSearch());
+		seed_solver = local_search_solver;
 		break;
 	}
+	}
 	if(seed_solver == nullptr) return;
+	seed_solver->SetWorkerCount(worker_count);
 
 	cout << "Seed Solver with seed algorithm " << seed_solver->GetName() << endl;
 	
@@ -251,15 +374,18 @@ void EVRP_Solver::SolveEVRP_Seed(SeedAlgorithm seed) const
 	s = {};
 	
 	const auto GA_solver = new GeneticAlgorithmOptimizer(problem_definition);
+	GA_solver->SetWorkerCount(worker_count);
+	ConfigureGA(GA_solver);
 	GA_solver->SetSeedSolutions(seed_solver->GetFoundTours());
 	GA_solver->Optimize(s);
 }
 
 /**
  * \brief Static write to file function that takes the results and writes to @WRITE_FILENAME.
- * We care about logging the results distance, name of the problem, algorithm name, and execution time.
+ * We care about logging the results distance, name of the problem, algorithm name and execution time.
  * We also care about writing the solution and the hyperparameters to the file in case we want to do more
  * evaluation on the specifics that went into generating this solution.
+ * The number of threads it ran on is appended as the last column so existing readers of the file keep working.
  * \param result A const reference to the optimization_results data structure that holds the information we care about
  */
 void EVRP_Solver::WriteToFile(const optimization_result& result) const
@@ -292,24 +418,12 @@ void EVRP_Solver::WriteToFile(const optimization_result& result) const
 		hyper_parameters += iter + "|";
 	}
 	hyper_parameters.pop_back();
-	file << hyper_parameters;
+	file << hyper_parameters << ",";
+
+	//The number of threads, since the execution time is wall-clock time
+	file << result.worker_count;
 	
 	file << "\n";
 
 	file.close();
 }
-
-ULARGE_INTEGER EVRP_Solver::get_thread_CPU_time(HANDLE h_thread) const
-{
-	FILETIME ftCreation, ftExit, ftKernel, ftUser;
-	ULARGE_INTEGER ulKernel, ulUser;
-	if (GetThreadTimes(h_thread, &ftCreation, &ftExit, &ftKernel, &ftUser)) {
-		ulKernel.HighPart = ftKernel.dwHighDateTime;
-		ulKernel.LowPart = ftKernel.dwLowDateTime;
-		ulUser.HighPart = ftUser.dwHighDateTime;
-		ulUser.LowPart = ftUser.dwLowDateTime;
-	}
-	ULARGE_INTEGER total;
-	total.QuadPart = ulKernel.QuadPart + ulUser.QuadPart;
-	return total;
-}
@@ -3,6 +3,12 @@
 #include <windows.h>
 
 #include "ProblemDefinition.h"
+#include "Algorithms/GA/CrossoverOperators.h"
+#include "Algorithms/LocalSearch/LocalSearch.h"
+#include "RouteCache.h"
+
+class AlgorithmBase;
+class GeneticAlgorithmOptimizer;
 //#include <mutex>
 
 enum
@@ -29,19 +35,37 @@ public:
 	enum SeedAlgorithm
 	{
 		NEH,
-		RNG
+		RNG,
+		Savings,
+		ALNS,
+		LocalOptima
 	};
 	
 	EVRP_Solver(const string &file_name);
 	void DebugEVRP() const;
+	void BenchmarkEVRP() const;
+	void BenchmarkSplitEVRP() const;
 	void SolveEVRP() const;
+	void SolveEVRP_Islands() const;
+	void SolveEVRP_Memetic() const;
 	void SolveEVRP_Seed(SeedAlgorithm seed) const;
 	bool IsGoodOpen() const { return _is_good_open;}
+	/** Sets how many threads each algorithm runs on, see AlgorithmBase::SetWorkerCount. Values below 1 use every hardware thread */
+	void SetWorkerCount(const int workers) { worker_count = workers; }
+	/** Sets the crossover every Genetic Algorithm of this solver breeds its children with, see GeneticAlgorithmOptimizer::SetCrossoverOperator */
+	void SetCrossoverOperator(const CrossoverOperator crossover) { crossover_operator = crossover; }
+	/** Sets the number of customers from which on the local search only tries the moves that touch the neighbor lists, see LocalSearch::SetGranular. 0 always does */
+	void SetGranularSearchMinCustomers(const int customers) { granular_min_customers = customers; }
+	/** Sets how many routes the route cache of every Genetic Algorithm of this solver holds, see AlgorithmBase::EnableRouteCache. 0 turns the cache off */
+	void SetRouteCacheCapacity(const size_t capacity) { route_cache_capacity = capacity; }
 	//vector<HANDLE> GetThreadHandles() const { return thread_handles;}
 
 	
 
 private:
+	void RunAlgorithm(AlgorithmBase *alg) const;
+	void ConfigureGA(GeneticAlgorithmOptimizer *alg) const;
+	bool UseGranularSearch() const;
 	void WriteToFile(const optimization_result &result) const;
 	
 	//int vehicleLoadCapacity;/*!< A temporary variable to store the inventory load capacity when we are actively parsing the data file*/
@@ -54,7 +78,9 @@ private:
 
 	string _current_filename;
 	bool _is_good_open;
-
-	ULARGE_INTEGER get_thread_CPU_time(HANDLE h_thread) const;
+	int worker_count = 0; /*!< Number of threads each algorithm runs on, lowered when several solves share the machine*/
+	CrossoverOperator crossover_operator = SinglePointCrossover; /*!< Crossover of every Genetic Algorithm this solver runs*/
+	int granular_min_customers = GRANULAR_SEARCH_MIN_CUSTOMERS; /*!< Number of customers from which on every local search this solver runs is granular*/
+	size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY; /*!< Number of routes the route cache of every Genetic Algorithm holds, 0 runs them without one*/
 };
 
@@ -1,12 +1,11 @@
 #include "HelperFunctions.h"
 
 #include <iostream>
-#include <random>
 
 /**
 * Helper functions used in the Genetic Algorithm code
 *
-* Pseudo-random number generator that implements the standard C++ Mersenne Twister algorithm
+* Pseudo-random number generator that draws from the calling thread's RandomGenerator, see RandomGenerator::ThreadLocal
 *
 * @param min The lower end of the range of values in the uniform distribution (inclusive)
 * @param max The upper end of the range of values in the uniform distribution (inclusive)
@@ -15,16 +14,28 @@
 */
 int HelperFunctions::RandomNumberGenerator(const int min, const int max)
 {
-	random_device rd;
-	mt19937 generator(rd());
-	uniform_int_distribution<> distribution(min, max);
-	return distribution(generator);
+	return RandomGenerator::ThreadLocal().NextInt(min, max);
+}
+
+/**
+* Same as RandomNumberGenerator(min, max), but draws from a caller-owned generator. This is what the
+* multithreaded code uses, so that each worker has its own random number stream.
+*
+* @param min The lower end of the range of values in the uniform distribution (inclusive)
+* @param max The upper end of the range of values in the uniform distribution (inclusive)
+* @param generator The random number stream to draw from
+*
+* @return A uniformly distributed integer between min (inclusive) and max (inclusive)
+*/
+int HelperFunctions::RandomNumberGenerator(const int min, const int max, RandomGenerator &generator)
+{
+	return generator.NextInt(min, max);
 }
 
 /**
 * Helper functions used in the Genetic Algorithm code.
 *
-* Shuffles a generic vector in place using the Mersenne Twister algorithm for the random number generator
+* Shuffles a generic vector in place using the calling thread's RandomGenerator, see RandomGenerator::ThreadLocal
 *
 * @param container The vector that needs to be shuffled
 *
@@ -32,9 +43,24 @@ int HelperFunctions::RandomNumberGenerator(const int min, const int max)
 */
 void HelperFunctions::ShuffleVector(vector<int>& container)
 {
-	random_device rd;
-	mt19937 generator(rd());
-	shuffle(container.begin(), container.end(), generator);
+	ShuffleVector(container, RandomGenerator::ThreadLocal());
+}
+
+/**
+* Helper functions used in the Genetic Algorithm code.
+*
+* Shuffles a vector in place with a Fisher-Yates shuffle. Unlike std::shuffle, this gives the same order on
+* every compiler for the same random number stream, so seeded runs can be replayed anywhere.
+*
+* @param container The vector that needs to be shuffled
+* @param generator The random number stream to draw from
+*/
+void HelperFunctions::ShuffleVector(vector<int>& container, RandomGenerator &generator)
+{
+	for (int i = static_cast<int>(container.size()) - 1; i > 0; i--)
+	{
+		swap(container[i], container[generator.NextInt(0, i)]);
+	}
 }
 
 /**
@@ -108,8 +134,42 @@ vector<Node> HelperFunctions::GetNodeDecodedTour(const ProblemDefinition *proble
 	
 	for(const auto &i:tour)
 	{
-		node_tour.push_back(problem->GetAllNodes()[i]);
+		node_tour.push_back(problem->GetNodeFromIndex(i));
 	}
 	return node_tour;
 }
 
+/**
+* Helper functions used in the Genetic Algorithm code.
+*
+* Counts how many nodes at the start of two tours are the same, which is how much of a previous
+* evaluation can be reused by RouteEvaluator::EvaluateIncremental.
+*
+* @param tour_1 The first tour
+* @param tour_2 The second tour
+*
+* @return The length of the longest common prefix of the two tours
+*/
+int HelperFunctions::SharedPrefixLength(const vector<int> &tour_1, const vector<int> &tour_2)
+{
+	return SharedPrefixLength(tour_1.data(), tour_2.data(), static_cast<int>(min(tour_1.size(), tour_2.size())));
+}
+
+/**
+* Same as SharedPrefixLength for two tours, but for tours that are rows of a SolutionSet.
+*
+* @param tour_1 The first tour
+* @param tour_2 The second tour
+* @param length The number of customers in both tours
+*
+* @return The length of the longest common prefix of the two tours
+*/
+int HelperFunctions::SharedPrefixLength(const int *tour_1, const int *tour_2, const int length)
+{
+	int shared = 0;
+	while (shared < length && tour_1[shared] == tour_2[shared])
+	{
+		shared++;
+	}
+	return shared;
+}
@@ -1,15 +1,20 @@
 #pragma once
 #include "ProblemDefinition.h"
+#include "RandomGenerator.h"
 
 class HelperFunctions
 {
 public:
 	static int RandomNumberGenerator(const int min, const int max);
+	static int RandomNumberGenerator(const int min, const int max, RandomGenerator &generator);
 	static void ShuffleVector(vector<int>& container);
+	static void ShuffleVector(vector<int>& container, RandomGenerator &generator);
 	static void PrintTour(const vector<int> &tour);
 	static vector<int> GenerateRandomTour(const int customerStart, const int size);
 	static float CalculateInterNodeDistance(const Node& node1, const Node& node2);
 	static vector<int> GetIndexEncodedTour(const vector<Node> &tour);
 	static vector<Node> GetNodeDecodedTour(const ProblemDefinition *problem, const vector<int> &tour);
+	static int SharedPrefixLength(const vector<int> &tour_1, const vector<int> &tour_2);
+	static int SharedPrefixLength(const int *tour_1, const int *tour_2, int length);
 };
 
@@ -1,13 +1,302 @@
 ﻿#include "ProblemDefinition.h"
 
-#include <random>
+#include <algorithm>
+#include <limits>
 
-vector<Node> ProblemDefinition::GenerateRandomTour() const
+#include "HelperFunctions.h"
+#include "SpatialIndex.h"
+
+vector<int> ProblemDefinition::GenerateRandomTour() const
+{
+    return GenerateRandomTour(RandomGenerator::ThreadLocal());
+}
+
+vector<int> ProblemDefinition::GenerateRandomTour(RandomGenerator &generator) const
 {
-    random_device rd;
-    mt19937 rng(rd());
-    vector<Node> shuffled = customer_nodes;
-    shuffle(shuffled.begin(), shuffled.end(), rng);
+    vector<int> shuffled;
+    shuffled.reserve(customer_nodes.size());
+    for (const auto &customer : customer_nodes)
+    {
+        shuffled.push_back(customer.index);
+    }
+    HelperFunctions::ShuffleVector(shuffled, generator);
     return shuffled;
 }
 
+
+/**
+* Precomputes the distance between every pair of nodes.
+*
+* Every fitness evaluation needs the distances between consecutive nodes on the tour, and calculating
+* hypot() every time is the most expensive part of the simulation. The matrix is stored flat and row-major,
+* so Distance() is a single multiply-add and an array read. Node indices are assigned in the order the nodes
+* are read from the file, so the index of a node is also its row in the matrix.
+*/
+void ProblemDefinition::BuildDistanceMatrix()
+{
+    node_count = static_cast<int>(all_nodes.size());
+    distance_matrix.assign(static_cast<size_t>(node_count) * node_count, 0.f);
+
+    for (int i = 0; i < node_count; i++)
+    {
+        //GetNodeFromIndex and Distance both rely on a node's index being its position in all_nodes
+        assert(all_nodes[i].index == i);
+        for (int j = i + 1; j < node_count; j++)
+        {
+            const float dist = HelperFunctions::CalculateInterNodeDistance(all_nodes[i], all_nodes[j]);
+            distance_matrix[i * node_count + j] = dist;
+            distance_matrix[j * node_count + i] = dist;
+        }
+    }
+}
+
+/**
+* Precomputes the nearest charging station for every node, and the battery needed to reach it.
+*
+* Checking if the vehicle can safely arrive at a node means checking that it can still reach a charging
+* station from there. This is done for every arc of every evaluation, so instead of scanning the charging
+* stations each time we look up the answer here. A charging station is never its own nearest charger, since
+* arriving at a charger with no battery left is not considered safe.
+* 
+* The charging stations are put in a SpatialIndex, which answers the nearest charger queries here and the
+* in-range queries of GetChargersInRange. Every node also gets the list of all charging stations sorted by
+* distance, so the charging stations in range of a battery level are a prefix of it.
+*/
+void ProblemDefinition::BuildChargerTables()
+{
+    vector<int> charger_indices;
+    charger_indices.reserve(charger_nodes.size());
+    charger_position.assign(node_count, -1);
+    for (size_t position = 0; position < charger_nodes.size(); position++)
+    {
+        charger_indices.push_back(charger_nodes[position].index);
+        charger_position[charger_nodes[position].index] = static_cast<int>(position);
+    }
+    charger_index = make_shared<const SpatialIndex>(all_nodes, charger_indices);
+
+    nearest_charger.assign(node_count, -1);
+    safe_reach_battery.assign(node_count, numeric_limits<float>::max());
+
+    for (const auto &node : all_nodes)
+    {
+        nearest_charger[node.index] = charger_index->Nearest(node.x, node.y, node.index);
+        if (nearest_charger[node.index] != -1)
+        {
+            safe_reach_battery[node.index] = Distance(node.index, nearest_charger[node.index]) * vehicle_parameters.battery_consumption_rate;
+        }
+    }
+
+    const int chargers = static_cast<int>(charger_nodes.size());
+    chargers_by_distance.resize(static_cast<size_t>(node_count) * chargers);
+    for (int index = 0; index < node_count; index++)
+    {
+        const auto row = chargers_by_distance.begin() + static_cast<size_t>(index) * chargers;
+        for (int position = 0; position < chargers; position++)
+        {
+            row[position] = position;
+        }
+        stable_sort(row, row + chargers, [this, index](const int a, const int b)
+        {
+            return Distance(index, charger_nodes[a].index) < Distance(index, charger_nodes[b].index);
+        });
+    }
+}
+
+/**
+* Precomputes the shortest path between every pair of charging stations using Floyd-Warshall.
+*
+* Two charging stations are connected if a fully charged vehicle can drive directly from one to the other.
+* Since the vehicle recharges fully at every charging station it visits, any chain of these edges is a
+* feasible way to cross the map, and the shortest chain is the cheapest charging detour between them.
+* The shortest ways into the charger graph from every node are precomputed from these too, see GetChargerDistancesInRange.
+*/
+void ProblemDefinition::BuildChargerGraph()
+{
+    charger_count = static_cast<int>(charger_nodes.size());
+    charger_path_distance.assign(static_cast<size_t>(charger_count) * charger_count, numeric_limits<float>::max());
+    charger_path_next.assign(static_cast<size_t>(charger_count) * charger_count, -1);
+
+    for (int a = 0; a < charger_count; a++)
+    {
+        for (int b = 0; b < charger_count; b++)
+        {
+            const float dist = Distance(charger_nodes[a], charger_nodes[b]);
+            if (a == b || dist * vehicle_parameters.battery_consumption_rate <= vehicle_parameters.battery_capacity)
+            {
+                charger_path_distance[a * charger_count + b] = dist;
+                charger_path_next[a * charger_count + b] = b;
+            }
+        }
+    }
+
+    for (int k = 0; k < charger_count; k++)
+    {
+        for (int i = 0; i < charger_count; i++)
+        {
+            const float to_k = charger_path_distance[i * charger_count + k];
+            if (charger_path_next[i * charger_count + k] == -1) continue;
+
+            for (int j = 0; j < charger_count; j++)
+            {
+                if (charger_path_next[k * charger_count + j] == -1) continue;
+
+                const float through_k = to_k + charger_path_distance[k * charger_count + j];
+                if (through_k < charger_path_distance[i * charger_count + j])
+                {
+                    charger_path_distance[i * charger_count + j] = through_k;
+                    charger_path_next[i * charger_count + j] = charger_path_next[i * charger_count + k];
+                }
+            }
+        }
+    }
+
+    //a vehicle that can reach the k closest charging stations can get to every other station through the closest k-1, or through the k-th
+    charger_distance_in_range.assign(static_cast<size_t>(node_count) * charger_count * charger_count, numeric_limits<float>::max());
+    for (int index = 0; index < node_count; index++)
+    {
+        const int *by_distance = chargers_by_distance.data() + static_cast<size_t>(index) * charger_count;
+        for (int in_range = 1; in_range <= charger_count; in_range++)
+        {
+            float *row = charger_distance_in_range.data() + (static_cast<size_t>(index) * charger_count + in_range - 1) * charger_count;
+            if (in_range > 1) copy(row - charger_count, row, row);
+
+            const int first = by_distance[in_range - 1];
+            const float to_first = Distance(index, charger_nodes[first].index);
+            for (int last = 0; last < charger_count; last++)
+            {
+                if (charger_path_next[first * charger_count + last] == -1) continue;
+                row[last] = min(row[last], to_first + charger_path_distance[first * charger_count + last]);
+            }
+        }
+    }
+
+    //the last leg of a detour, from the charger graph to the destination, doesn't depend on where the detour
+    //started or how much battery the vehicle had, so the best way out of the graph to every node is precomputed too
+    charger_exit_distance.assign(static_cast<size_t>(charger_count) * node_count, numeric_limits<float>::max());
+    charger_exit_last.assign(static_cast<size_t>(charger_count) * node_count, -1);
+    for (int first = 0; first < charger_count; first++)
+    {
+        for (int end = 0; end < node_count; end++)
+        {
+            for (int last = 0; last < charger_count; last++)
+            {
+                const int last_index = charger_nodes[last].index;
+                if (charger_path_next[first * charger_count + last] == -1 || last_index == end) continue;
+                if (!CanReachSafely(last_index, end, vehicle_parameters.battery_capacity)) continue;
+
+                const float total = charger_path_distance[first * charger_count + last] + Distance(last_index, end);
+                if (total < charger_exit_distance[first * node_count + end])
+                {
+                    charger_exit_distance[first * node_count + end] = total;
+                    charger_exit_last[first * node_count + end] = last;
+                }
+            }
+        }
+    }
+}
+
+/**
+* Finds the shortest detour through charging stations from one node to another.
+*
+* The detour is: drive from start to a first charging station within range of the current battery level,
+* follow the precomputed shortest path through the charger graph to a last charging station, then drive
+* from there to end with a full battery. The best last charging station for every first one is precomputed,
+* so only the first charging station needs to be searched here, out of the ones in range as found by
+* GetChargersInRange. The result is the shortest such detour, not just the one the vehicle would stumble upon
+* by always hopping to the charger closest to the destination.
+*
+* @param start The index of the node the vehicle is at
+* @param end The index of the node the vehicle wants to get to
+* @param battery_level The battery the vehicle has when leaving start
+* @param out_chargers Filled with the indices of the charging stations to visit, in order
+*
+* @return False if there is no feasible detour, in which case out_chargers is left empty
+*/
+bool ProblemDefinition::FindChargingDetour(const int start, const int end, const float battery_level, vector<int> &out_chargers) const
+{
+    float best_distance = numeric_limits<float>::max();
+    int best_first = -1;
+    int best_last = -1;
+
+    //out_chargers holds the candidates for the first charging station until the best detour is known
+    GetChargersInRange(start, battery_level, out_chargers);
+    for (const int first_index : out_chargers)
+    {
+        if (first_index == start) continue;
+
+        const int first = charger_position[first_index];
+        const int last = charger_exit_last[first * node_count + end];
+        if (last == -1) continue;
+
+        //ties go to the charging station that comes first in charger_nodes, whatever order the index returned them in
+        const float total = Distance(start, first_index) + charger_exit_distance[first * node_count + end];
+        if (total < best_distance || (total == best_distance && first < best_first))
+        {
+            best_distance = total;
+            best_first = first;
+            best_last = last;
+        }
+    }
+
+    out_chargers.clear();
+    if (best_first == -1) return false;
+
+    //walk the shortest path from the first to the last charging station
+    int current = best_first;
+    out_chargers.push_back(charger_nodes[current].index);
+    while (current != best_last)
+    {
+        current = charger_path_next[current * charger_count + best_last];
+        out_chargers.push_back(charger_nodes[current].index);
+    }
+    return true;
+}
+
+/**
+* Builds the candidate lists of the closest customers to every node, see GetNeighbors.
+*
+* The lists are looked up in a SpatialIndex over the customers instead of by sorting a row of the distance matrix
+* per node, so building them takes O(n log n) for n customers rather than O(n^2 log n).
+*
+* @param k The number of customers in every list. It is capped at the number of customers other than the node itself
+*/
+void ProblemDefinition::SetNeighborCount(const int k)
+{
+    vector<int> customer_indices;
+    customer_indices.reserve(customer_nodes.size());
+    for (const auto &customer : customer_nodes)
+    {
+        customer_indices.push_back(customer.index);
+    }
+    const SpatialIndex customer_index(all_nodes, customer_indices);
+
+    neighbor_count = max(0, min(k, static_cast<int>(customer_nodes.size()) - 1));
+    neighbor_lists.assign(static_cast<size_t>(node_count) * neighbor_count, -1);
+
+    vector<int> nearest;
+    for (const auto &node : all_nodes)
+    {
+        customer_index.KNearest(node.x, node.y, neighbor_count, node.index, nearest);
+        copy(nearest.begin(), nearest.end(), neighbor_lists.begin() + static_cast<size_t>(node.index) * neighbor_count);
+    }
+}
+
+/**
+* Finds every charging station a vehicle can drive to directly with the battery it has left.
+*
+* @param from The index of the node the vehicle is at
+* @param battery_level The battery the vehicle has when leaving from
+* @param out_chargers Filled with the indices of the charging stations in range, in no particular order. If from is a charging station it is included
+*/
+void ProblemDefinition::GetChargersInRange(const int from, const float battery_level, vector<int> &out_chargers) const
+{
+    const float rate = vehicle_parameters.battery_consumption_rate;
+    const Node &node = all_nodes[from];
+
+    //the index works on the exact coordinates, so it searches a little further and the distance matrix has the final say
+    charger_index->WithinRadius(node.x, node.y, battery_level / rate + 0.001, out_chargers);
+    out_chargers.erase(remove_if(out_chargers.begin(), out_chargers.end(), [&](const int charger)
+    {
+        return Distance(from, charger) * rate > battery_level;
+    }), out_chargers.end());
+}
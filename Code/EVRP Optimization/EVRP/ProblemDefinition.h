@@ -1,7 +1,11 @@
 #pragma once
+#include <cassert>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "RandomGenerator.h"
+
 
 
 /***************************************************************************//**
@@ -15,6 +19,10 @@
 
 using namespace std;
 
+class SpatialIndex;
+
+constexpr int DEFAULT_NEIGHBOR_COUNT = 20; /*!< Default length of the candidate list of closest customers each node gets, see ProblemDefinition::SetNeighborCount */
+
 enum NodeType
 {
 	Depot,
@@ -82,6 +90,7 @@ struct optimization_result
 {
 	string algorithm_name;
 	float execution_time;
+	int worker_count; /*!< The number of threads the algorithm ran on, since the execution time is wall-clock time*/
 	float distance;
 	vector<int> solution_encoded;
 	vector<Node> solution_decoded;
@@ -125,33 +134,153 @@ public:
 		}
 
 		vehicle_parameters = vehicle_params;
+		BuildDistanceMatrix();
+		BuildChargerTables();
+		BuildChargerGraph();
+		SetNeighborCount(DEFAULT_NEIGHBOR_COUNT);
 	}
 
-	vector<Node> GenerateRandomTour() const;
+	vector<int> GenerateRandomTour() const;
+	vector<int> GenerateRandomTour(RandomGenerator &generator) const;
 	
-	Node GetDepotNode() const { return depot; }
-	vector<Node> GetAllNodes() const { return all_nodes; }
-	vector<Node> GetChargingNodes() const { return charger_nodes; }
-	vector<Node> GetCustomerNodes() const { return customer_nodes; }
-	VehicleParameters GetVehicleParameters() const { return vehicle_parameters; }
-	Node GetNodeFromIndex(const int index) const
+	//the node accessors return const references so that the evaluation code never copies the node lists
+	const Node &GetDepotNode() const { return depot; }
+	const vector<Node> &GetAllNodes() const { return all_nodes; }
+	const vector<Node> &GetChargingNodes() const { return charger_nodes; }
+	const vector<Node> &GetCustomerNodes() const { return customer_nodes; }
+	const VehicleParameters &GetVehicleParameters() const { return vehicle_parameters; }
+
+	/**
+	* Constant time node lookup. Node indices are assigned in the order the nodes are read from the
+	* problem file, so the index of a node is also its position in the list of all nodes.
+	*
+	* @param index The index of the node
+	*
+	* @return A reference to the node with that index
+	*/
+	const Node &GetNodeFromIndex(const int index) const
 	{
-		for(const auto &n : GetAllNodes())
-		{
-			if(n.index == index)
-			{
-				return n;
-			}
-		}
-		return {};
+		assert(index >= 0 && index < node_count);
+		return all_nodes[index];
 	}
-	
+	int GetNodeCount() const { return node_count; }
+
+	/**
+	* Constant time distance lookup between two nodes, using the matrix precomputed when the problem was loaded.
+	*
+	* @param from The index of the first node
+	* @param to The index of the second node
+	*
+	* @return The Euclidean distance between both nodes
+	*/
+	float Distance(const int from, const int to) const { return distance_matrix[from * node_count + to]; }
+	float Distance(const Node &from, const Node &to) const { return Distance(from.index, to.index); }
+
+	/**
+	* The closest charging station to a node, not counting the node itself if it is a charger.
+	*
+	* @param index The index of the node
+	*
+	* @return The index of the closest charging station, or -1 if there is no other charging station
+	*/
+	int GetNearestCharger(const int index) const { return nearest_charger[index]; }
+
+	/**
+	* The battery needed to get from a node to its nearest charging station, as returned by GetNearestCharger.
+	* A vehicle can only "safely" arrive at a node if it has more than this much battery left when it gets there.
+	*
+	* @param index The index of the node
+	*
+	* @return The battery cost of driving to the nearest charging station
+	*/
+	float GetSafeReachBattery(const int index) const { return safe_reach_battery[index]; }
+
+	/**
+	* Checks if a vehicle can drive from one node to another and still have enough battery left to reach
+	* a charging station from the destination.
+	*
+	* @param from The index of the node the vehicle starts at
+	* @param to The index of the node the vehicle wants to go to
+	* @param battery_level The battery the vehicle has when leaving the from node
+	*
+	* @return Whether or not the vehicle can safely get from one node to the other
+	*/
+	bool CanReachSafely(const int from, const int to, const float battery_level) const
+	{
+		if (nearest_charger[to] == -1) return false;
+		return battery_level > Distance(from, to) * vehicle_parameters.battery_consumption_rate + safe_reach_battery[to];
+	}
+
+	/**
+	* The charging stations ordered by their distance from a node, closest first.
+	*
+	* @param index The index of the node
+	*
+	* @return Pointer to the positions in GetChargingNodes() of all charging stations, including the node itself if it is one
+	*/
+	const int *GetChargersByDistance(const int index) const { return chargers_by_distance.data() + static_cast<size_t>(index) * charger_count; }
+
+	/**
+	* The shortest distance from a node through the charger graph to every charging station, for a vehicle that only
+	* has the battery to drive directly to the closest few stations, see GetChargersByDistance. The distance only depends
+	* on how many of the closest stations are in range, so it is precomputed for every count.
+	*
+	* @param index The index of the node
+	* @param chargers_in_range How many of the closest charging stations the vehicle can reach directly, at least 1
+	*
+	* @return Pointer to the distance to each charging station by position in GetChargingNodes(), numeric_limits<float>::max() for the unreachable ones
+	*/
+	const float *GetChargerDistancesInRange(const int index, const int chargers_in_range) const
+	{
+		assert(chargers_in_range >= 1 && chargers_in_range <= charger_count);
+		return charger_distance_in_range.data() + (static_cast<size_t>(index) * charger_count + chargers_in_range - 1) * charger_count;
+	}
+
+	bool FindChargingDetour(int start, int end, float battery_level, vector<int> &out_chargers) const;
+	void GetChargersInRange(int from, float battery_level, vector<int> &out_chargers) const;
+
+	void SetNeighborCount(int k);
+	int GetNeighborCount() const { return neighbor_count; }
+
+	/**
+	* The candidate list of a node: the #GetNeighborCount customers closest to it, closest first.
+	* Move-based searches can restrict themselves to moves that create an arc to one of these, which
+	* turns a scan over all O(n^2) pairs of customers into O(n k).
+	*
+	* @param index The index of the node, which can be any node including the depot
+	*
+	* @return Pointer to the first of #GetNeighborCount customer indices. A customer is never in its own list
+	*/
+	const int *GetNeighbors(const int index) const { return neighbor_lists.data() + static_cast<size_t>(index) * neighbor_count; }
+
 
 private:
+	void BuildDistanceMatrix();
+	void BuildChargerTables();
+	void BuildChargerGraph();
+
 	Node depot;
 	vector<Node> all_nodes;
 	vector<Node> customer_nodes;
 	vector<Node> charger_nodes;
 
 	VehicleParameters vehicle_parameters;
+
+	int node_count = 0; /*!< Number of nodes in the problem, and the row stride of #distance_matrix */
+	vector<float> distance_matrix; /*!< Flat node_count x node_count row-major matrix of every inter-node distance */
+	shared_ptr<const SpatialIndex> charger_index; /*!< Spatial index over the charging stations, for nearest and in-range queries */
+	vector<int> charger_position; /*!< For each node, its position in charger_nodes, or -1 if it isn't a charging station */
+	vector<int> nearest_charger; /*!< For each node, the index of the closest other charging station (-1 if there is none) */
+	vector<float> safe_reach_battery; /*!< For each node, the battery cost of driving to nearest_charger */
+	vector<int> chargers_by_distance; /*!< Flat node_count x charger_count matrix of the charging stations (positions in charger_nodes) by distance from every node, see GetChargersByDistance */
+
+	int charger_count = 0; /*!< Number of charging stations, and the row stride of the charger path matrices */
+	vector<float> charger_path_distance; /*!< Shortest battery-feasible distance between every pair of charging stations, indexed by position in charger_nodes */
+	vector<int> charger_path_next; /*!< The next charging station (position in charger_nodes) on the shortest path between every pair, or -1 if unreachable */
+	vector<float> charger_exit_distance; /*!< For every charging station and node, the shortest path through the charger graph that ends by driving safely to the node */
+	vector<int> charger_exit_last; /*!< The last charging station (position in charger_nodes) on the path in charger_exit_distance, or -1 if there is none */
+	vector<float> charger_distance_in_range; /*!< Flat node_count x charger_count x charger_count table, see GetChargerDistancesInRange */
+
+	int neighbor_count = 0; /*!< Length of every candidate list, and the row stride of #neighbor_lists */
+	vector<int> neighbor_lists; /*!< Flat node_count x neighbor_count matrix of the closest customers to every node, see GetNeighbors */
 };
@@ -0,0 +1,123 @@
+#include "RandomGenerator.h"
+
+atomic<uint64_t> RandomGenerator::run_seed{0};
+atomic<uint64_t> RandomGenerator::next_thread_stream{0};
+
+uint64_t RandomGenerator::RotateLeft(const uint64_t x, const int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+* SplitMix64, used to spread a single seed out over the 256 bits of xoshiro256** state.
+* The thread-local streams use it to get a seed of their own from the run seed, too.
+*
+* @param x The SplitMix64 state, which is advanced by the call
+*
+* @return The next SplitMix64 output
+*/
+uint64_t RandomGenerator::SplitMix64(uint64_t &x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+* Creates the generator for one stream of a seed in constant time, however large the stream number is.
+* The stream number is put through SplitMix64 on its own and mixed into the seed, which gives every stream
+* a different SplitMix64 state to spread over the xoshiro256** state.
+*
+* @param seed The seed of the run, or of the algorithm if it was given one of its own
+* @param stream Which of the independent streams of that seed to use, such as the number of a task
+*/
+RandomGenerator::RandomGenerator(uint64_t seed, uint64_t stream)
+{
+	uint64_t x = SplitMix64(seed) ^ SplitMix64(stream);
+	for (auto &s : state)
+	{
+		s = SplitMix64(x);
+	}
+}
+
+RandomGenerator::result_type RandomGenerator::operator()()
+{
+	const uint64_t result = RotateLeft(state[1] * 5, 7) * 9;
+	const uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = RotateLeft(state[3], 45);
+
+	return result;
+}
+
+/**
+* Draws a uniformly distributed integer with Lemire's multiply-and-shift method, which only needs a
+* division in the rare case that a draw has to be rejected to keep the distribution unbiased.
+*
+* @param min The lower end of the range of values (inclusive)
+* @param max The upper end of the range of values (inclusive)
+*
+* @return A uniformly distributed integer between min (inclusive) and max (inclusive)
+*/
+int RandomGenerator::NextInt(const int min, const int max)
+{
+	const uint32_t range = static_cast<uint32_t>(max - min) + 1;
+	uint64_t product = (operator()() >> 32) * range;
+	uint32_t low = static_cast<uint32_t>(product);
+	if (low < range)
+	{
+		const uint32_t threshold = (0u - range) % range;
+		while (low < threshold)
+		{
+			product = (operator()() >> 32) * range;
+			low = static_cast<uint32_t>(product);
+		}
+	}
+	return min + static_cast<int>(product >> 32);
+}
+
+/**
+* Draws a uniformly distributed number from the top 53 bits of a draw, which is every double in the range that is a multiple of 2^-53.
+*
+* @return A uniformly distributed number between 0 (inclusive) and 1 (exclusive)
+*/
+double RandomGenerator::NextDouble()
+{
+	return static_cast<double>(operator()() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+* Sets the seed that every thread-local generator and every algorithm without a seed of its own is derived from.
+* This should be called once at the start of the run, before any thread has drawn a random number.
+*
+* @param seed The seed of the run. Printing it at the start of the run is enough to be able to replay it
+*/
+void RandomGenerator::SetRunSeed(const uint64_t seed)
+{
+	run_seed.store(seed);
+}
+
+/**
+* The generator of the calling thread, for code that doesn't get a generator passed in. The first call on each
+* thread creates the generator with the next free stream of the run seed, so the streams of the threads are
+* independent of each other, but which thread gets which stream depends on the order the threads first draw in.
+* Code that has to be replayed exactly with several threads should create its own RandomGenerator per task instead.
+*
+* @return The generator of the calling thread
+*/
+RandomGenerator &RandomGenerator::ThreadLocal()
+{
+	//the thread-local streams come from a seed of their own, so they are unrelated to the task streams of the run seed
+	thread_local RandomGenerator generator = []
+	{
+		uint64_t seed = run_seed.load();
+		return RandomGenerator(SplitMix64(seed), next_thread_stream.fetch_add(1));
+	}();
+	return generator;
+}
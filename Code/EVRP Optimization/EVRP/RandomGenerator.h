@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/***************************************************************************//**
+ * Fast, seedable random number stream based on xoshiro256**.
+ *
+ * The whole state is 32 bytes, so generators are cheap to create and to keep one per
+ * worker thread or even one per task, unlike mt19937 and its 5 KB of state. A generator
+ * is identified by a seed and a stream number: the stream number is hashed into the seed
+ * before it is spread over the state, so creating any stream takes constant time, and
+ * every stream starts at its own random point of the 2^256 - 1 long xoshiro256** sequence.
+ * Streams of the same seed overlapping within any realistic number of draws is
+ * astronomically unlikely, so parallel tasks seeded with the same seed and different
+ * stream numbers don't see correlated numbers, and a run can be replayed exactly by
+ * reusing its seed.
+ *
+ * It satisfies the standard UniformRandomBitGenerator requirements, but NextInt and
+ * HelperFunctions::ShuffleVector should be preferred over the standard distributions,
+ * since those are implemented differently by every standard library and would make
+ * the same seed give different runs on different compilers.
+ ******************************************************************************/
+class RandomGenerator
+{
+public:
+	typedef uint64_t result_type;
+
+	RandomGenerator(uint64_t seed, uint64_t stream);
+
+	result_type operator()();
+	int NextInt(int min, int max);
+	double NextDouble();
+
+	//the parentheses stop the min and max macros from windows.h from expanding here
+	static constexpr result_type (min)() { return 0; }
+	static constexpr result_type (max)() { return UINT64_MAX; }
+
+	static void SetRunSeed(uint64_t seed);
+	static uint64_t GetRunSeed() { return run_seed.load(); }
+	static RandomGenerator &ThreadLocal();
+
+private:
+	static uint64_t RotateLeft(uint64_t x, int k);
+	static uint64_t SplitMix64(uint64_t &x);
+
+	uint64_t state[4];
+
+	static atomic<uint64_t> run_seed; /*!< The seed of the whole run, see SetRunSeed*/
+	static atomic<uint64_t> next_thread_stream; /*!< Stream number handed to the next thread that calls ThreadLocal*/
+};
@@ -0,0 +1,150 @@
+#include "RouteCache.h"
+
+#include <algorithm>
+
+/**
+* @param capacity The most routes the cache holds, spread evenly over the shards
+*/
+RouteCache::RouteCache(const size_t capacity) : shards(ROUTE_CACHE_SHARDS)
+{
+	shard_capacity = max<size_t>(1, capacity / ROUTE_CACHE_SHARDS);
+}
+
+/**
+* Hashes a sequence of customers with a polynomial rolling hash, so the hash of a route can be built up one
+* customer at a time while the route is found. The result is mixed with the splitmix64 finalizer, since both the
+* shard and the hash map bucket are taken from it.
+*
+* @param customers The customers of the route, in order
+* @param count The number of customers
+* @param seed Mixed into the hash, so that routes driven in different ways don't share entries
+*
+* @return The hash of the route
+*/
+uint64_t RouteCache::HashRoute(const int *customers, const int count, const uint64_t seed)
+{
+	uint64_t hash = seed;
+	for (int i = 0; i < count; i++)
+	{
+		hash = hash * 0x100000001B3ull + static_cast<uint64_t>(customers[i]) + 1;
+	}
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	return hash ^ (hash >> 31);
+}
+
+/**
+* Looks up a route, and marks it as used so the clock hand passes it over once.
+*
+* @param hash The hash of the route, see HashRoute
+* @param customers The customers of the route, in order
+* @param count The number of customers
+* @param out_route Receives a copy of the route if it is in the cache. A copy, since another thread may evict it right after
+*
+* @return Whether the route was in the cache
+*/
+bool RouteCache::Find(const uint64_t hash, const int *customers, const int count, CachedRoute &out_route)
+{
+	Shard &shard = ShardOf(hash);
+	lock_guard<mutex> lock(shard.shard_mutex);
+
+	const auto it = shard.slot_of_hash.find(hash);
+	if (it == shard.slot_of_hash.end())
+	{
+		shard.misses++;
+		return false;
+	}
+
+	Slot &slot = shard.slots[it->second];
+	if (static_cast<int>(slot.customers.size()) != count || !equal(slot.customers.begin(), slot.customers.end(), customers))
+	{
+		shard.misses++;
+		return false;
+	}
+
+	slot.referenced = true;
+	shard.hits++;
+	out_route.distance = slot.route.distance;
+	out_route.return_battery = slot.route.return_battery;
+	out_route.checkpoints.assign(slot.route.checkpoints.begin(), slot.route.checkpoints.end());
+	return true;
+}
+
+/**
+* Adds a route to the cache. If its shard is full, the CLOCK policy evicts another route to make room, see RouteCache.
+* A route with the same hash that is already in the cache is replaced.
+*
+* @param hash The hash of the route, see HashRoute
+* @param customers The customers of the route, in order
+* @param count The number of customers
+* @param route What driving the route resulted in
+*/
+void RouteCache::Insert(const uint64_t hash, const int *customers, const int count, const CachedRoute &route)
+{
+	Shard &shard = ShardOf(hash);
+	lock_guard<mutex> lock(shard.shard_mutex);
+
+	int slot_index;
+	const auto it = shard.slot_of_hash.find(hash);
+	if (it != shard.slot_of_hash.end())
+	{
+		slot_index = it->second;
+	}
+	else if (shard.slots.size() < shard_capacity)
+	{
+		slot_index = static_cast<int>(shard.slots.size());
+		shard.slots.emplace_back();
+		shard.slot_of_hash.emplace(hash, slot_index);
+	}
+	else
+	{
+		while (shard.slots[shard.clock_hand].referenced)
+		{
+			shard.slots[shard.clock_hand].referenced = false;
+			shard.clock_hand = (shard.clock_hand + 1) % static_cast<int>(shard.slots.size());
+		}
+		slot_index = shard.clock_hand;
+		shard.clock_hand = (shard.clock_hand + 1) % static_cast<int>(shard.slots.size());
+
+		shard.slot_of_hash.erase(shard.slots[slot_index].hash);
+		shard.slot_of_hash.emplace(hash, slot_index);
+		shard.evictions++;
+	}
+
+	//the vectors of a reused slot keep their memory, so a full cache doesn't allocate
+	Slot &slot = shard.slots[slot_index];
+	slot.hash = hash;
+	slot.customers.assign(customers, customers + count);
+	slot.route.distance = route.distance;
+	slot.route.return_battery = route.return_battery;
+	slot.route.checkpoints.assign(route.checkpoints.begin(), route.checkpoints.end());
+	slot.referenced = false;
+}
+
+RouteCacheStatistics RouteCache::GetStatistics() const
+{
+	RouteCacheStatistics statistics = {};
+	for (const auto &shard : shards)
+	{
+		lock_guard<mutex> lock(shard.shard_mutex);
+		statistics.hits += shard.hits;
+		statistics.misses += shard.misses;
+		statistics.evictions += shard.evictions;
+		statistics.size += shard.slots.size();
+	}
+	return statistics;
+}
+
+void RouteCache::Clear()
+{
+	for (auto &shard : shards)
+	{
+		lock_guard<mutex> lock(shard.shard_mutex);
+		shard.slot_of_hash.clear();
+		shard.slots.clear();
+		shard.clock_hand = 0;
+		shard.hits = 0;
+		shard.misses = 0;
+		shard.evictions = 0;
+	}
+}
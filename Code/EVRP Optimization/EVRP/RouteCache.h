@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "RouteEvaluator.h"
+
+constexpr int ROUTE_CACHE_SHARDS = 64; /*!< Number of independently locked parts of a RouteCache, so threads rarely wait on each other */
+constexpr size_t DEFAULT_ROUTE_CACHE_CAPACITY = 1 << 16; /*!< Number of routes a RouteCache holds by default */
+
+/**
+* How well a RouteCache has been doing since it was created or cleared.
+*/
+struct RouteCacheStatistics
+{
+	long long hits;
+	long long misses;
+	long long evictions;
+	size_t size; /*!< The number of routes in the cache*/
+
+	double HitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0; }
+};
+
+/***************************************************************************//**
+ * Memoizes the routes the RouteEvaluator drives, keyed by their sequence of customers.
+ *
+ * With the greedy split, every route starts at the depot with a full battery and a full
+ * load, so what happens on it only depends on its customers. Once a population has
+ * converged, most children are made of routes some other tour already had, and looking
+ * them up is much cheaper than driving them again.
+ *
+ * Routes are keyed by a rolling hash of their customers, and the customers are stored with
+ * the route so that a hash collision is a miss instead of a wrong answer. The cache is split
+ * into #ROUTE_CACHE_SHARDS shards by hash, each with its own lock, so all threads can share
+ * one cache. Every shard holds a fixed number of routes, and once it is full the CLOCK policy
+ * picks the route to evict: the slots are visited in a circle, a route that was used since
+ * the last visit gets another round, and the first one that wasn't is replaced. That keeps
+ * the routes of the current population in the cache at the cost of one bit per route.
+ ******************************************************************************/
+class RouteCache
+{
+public:
+	explicit RouteCache(size_t capacity = DEFAULT_ROUTE_CACHE_CAPACITY);
+
+	static uint64_t HashRoute(const int *customers, int count, uint64_t seed);
+	bool Find(uint64_t hash, const int *customers, int count, CachedRoute &out_route);
+	void Insert(uint64_t hash, const int *customers, int count, const CachedRoute &route);
+
+	RouteCacheStatistics GetStatistics() const;
+	void Clear();
+
+private:
+	struct Slot
+	{
+		uint64_t hash = 0;
+		vector<int> customers;
+		CachedRoute route = {};
+		bool referenced = false; /*!< Whether the route was used since the clock hand last passed it*/
+	};
+
+	struct Shard
+	{
+		mutable mutex shard_mutex;
+		unordered_map<uint64_t, int> slot_of_hash;
+		vector<Slot> slots; /*!< Grows up to the capacity of the shard, after which slots are reused*/
+		int clock_hand = 0;
+
+		long long hits = 0;
+		long long misses = 0;
+		long long evictions = 0;
+	};
+
+	Shard &ShardOf(const uint64_t hash) { return shards[(hash >> 32) % ROUTE_CACHE_SHARDS]; }
+
+	vector<Shard> shards;
+	size_t shard_capacity;
+};
@@ -0,0 +1,651 @@
+#include "RouteEvaluator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include "HelperFunctions.h"
+#include "RouteCache.h"
+
+/**
+* Fitness calculation for the provided tour.
+* 
+* This function simulates the drive through the desired tour of customer nodes. Remember, the "solution"
+* is defined by the preferred order of visiting each customer node. This desired route doesn't take into 
+* account any visits to the charging stations or the depot, so we need to artificially add those in.
+* Since the EVRP gives us flexibility with when we visit these special nodes, and there is no requirement
+* that we *must* visit these nodes, we don't include any visits to these nodes in the desired route. 
+* 
+* This means that, since we don't know the true route once we start implementing constraints like fuel and capacity,
+* we must find out the "true" route. We do that in this function. The battery, inventory and time of the vehicle are
+* local variables, so this function can run on many threads at once as long as each has its own scratch buffer.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param scratch Buffers owned by the calling thread that the simulation can write to
+* @param verbose This is false by default, and will hide a lot of the print outputs. This should not be set to true unless you want to output one specific route. In general, the outputting adds a lot of time to the simulation execution
+* 
+* @return Returns the true distance that the desired route would actually traverse with the fuel and capacity constraints, and whether or not the route is feasible
+*/
+EvaluationResult RouteEvaluator::Evaluate(const vector<int> &tour, EvaluationScratch &scratch, bool verbose) const
+{
+	if(split_strategy == OptimalSplit) return Split(tour, NO_EVALUATION_CUTOFF, scratch, verbose);
+	if(charging_strategy == OptimalCharging) return PlanCharging(tour, NO_EVALUATION_CUTOFF, scratch, verbose);
+
+	const RouteCheckpoint depot_start = {problem_definition.GetDepotNode().index, max_inventory, max_battery, 0.f, 0.f, 0.f, 0.f};
+	return Simulate(tour, depot_start, 0, NO_EVALUATION_CUTOFF, scratch, verbose, nullptr);
+}
+
+/**
+* Evaluates a tour, but gives up on it as soon as the distance driven goes over the cutoff. This is for callers that
+* only care whether a tour beats some threshold, such as the best tour found so far: the distance only ever grows
+* during the simulation, so once it is over the cutoff the tour can't win anymore and the rest of it doesn't need
+* to be simulated. A tour that comes in at exactly the cutoff is evaluated in full.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param cutoff The distance past which the tour is of no interest to the caller
+* @param scratch Buffers owned by the calling thread that the simulation can write to
+* 
+* @return The same result as Evaluate if the tour didn't go over the cutoff, otherwise a result with dominated set
+*/
+EvaluationResult RouteEvaluator::Evaluate(const vector<int> &tour, const float cutoff, EvaluationScratch &scratch) const
+{
+	if(split_strategy == OptimalSplit) return Split(tour, cutoff, scratch, false);
+	if(charging_strategy == OptimalCharging) return PlanCharging(tour, cutoff, scratch, false);
+
+	const RouteCheckpoint depot_start = {problem_definition.GetDepotNode().index, max_inventory, max_battery, 0.f, 0.f, 0.f, 0.f};
+	return Simulate(tour, depot_start, 0, cutoff, scratch, false, nullptr);
+}
+
+/**
+* Evaluates a tour that starts with the same customers as a tour that has already been evaluated, such as
+* a crossover child and the parent it copied its first genes from. Instead of driving the shared prefix again,
+* the simulation resumes from the checkpoint the earlier evaluation recorded at the end of it, so only the part
+* of the tour that actually changed gets simulated. The result is exactly what Evaluate would return.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param prefix_trace The trace recorded for the earlier tour, or nullptr to simulate the whole tour
+* @param shared_prefix The number of customers at the start of tour that are the same as in the earlier tour
+* @param scratch Buffers owned by the calling thread that the simulation can write to
+* @param trace Filled with the checkpoints of this tour, so that it can be resumed from in turn. Must not be prefix_trace. Left empty with the OptimalSplit and OptimalCharging strategies
+* @param cutoff Stops the simulation once the distance goes over it, see Evaluate(tour, cutoff, scratch). The trace then ends where the simulation stopped
+* 
+* @return Returns the true distance of the tour and whether or not the route is feasible
+*/
+EvaluationResult RouteEvaluator::EvaluateIncremental(const vector<int> &tour, const RouteTrace *prefix_trace, int shared_prefix, EvaluationScratch &scratch, RouteTrace &trace, const float cutoff) const
+{
+	assert(prefix_trace != &trace);
+	trace.checkpoints.clear();
+	if(split_strategy == OptimalSplit) return Split(tour, cutoff, scratch, false);
+	if(charging_strategy == OptimalCharging) return PlanCharging(tour, cutoff, scratch, false);
+
+	if (prefix_trace == nullptr || prefix_trace->checkpoints.empty())
+	{
+		const RouteCheckpoint depot_start = {problem_definition.GetDepotNode().index, max_inventory, max_battery, 0.f, 0.f, 0.f, 0.f};
+		trace.checkpoints.push_back(depot_start);
+		return Simulate(tour, depot_start, 0, cutoff, scratch, false, &trace);
+	}
+
+	//an infeasible tour only has checkpoints up to the customer it got stuck at
+	shared_prefix = min(shared_prefix, static_cast<int>(prefix_trace->checkpoints.size()) - 1);
+	trace.checkpoints.assign(prefix_trace->checkpoints.begin(), prefix_trace->checkpoints.begin() + shared_prefix + 1);
+	return Simulate(tour, trace.checkpoints.back(), shared_prefix, cutoff, scratch, false, &trace);
+}
+
+/**
+* Drives the tour from the given state until the vehicle is back at the depot, see Evaluate.
+* 
+* With a RouteCache, every route that starts at the depot is looked up before it is driven, and a route that
+* wasn't in the cache is added once the vehicle is back at the depot. A verbose simulation drives every route.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param start The state of the vehicle before it heads to customer start_position
+* @param start_position The number of customers in tour that have already been serviced
+* @param cutoff The simulation stops with a dominated result as soon as the distance goes over this
+* @param scratch Buffers owned by the calling thread that the simulation can write to
+* @param verbose Prints every step of the simulation
+* @param trace If not nullptr, a checkpoint is appended to it every time a customer has been serviced
+* 
+* @return Returns the true distance of the tour and whether or not the route is feasible
+*/
+EvaluationResult RouteEvaluator::Simulate(const vector<int> &tour, const RouteCheckpoint &start, const int start_position, const float cutoff, EvaluationScratch &scratch, const bool verbose, RouteTrace *trace) const
+{
+	if(verbose)
+	{
+		cout << "Simulating drive of ";
+		HelperFunctions::PrintTour(tour);
+		scratch.padded_tour.clear();
+		//we start the padded tour at the depot (or node 0)
+		scratch.padded_tour.push_back(start.node);
+	}
+
+	float current_battery = start.battery;
+	int current_inventory = start.inventory;
+
+	//we will track the full distance of the route in case there's any early returns
+	float full_distance = start.distance;
+	float finished_distance = start.finished_distance;
+	float route_distance = start.route_distance;
+	float route_time = start.time;
+	
+	int current_node_index = start.node;
+	int customer_nodes_serviced = start_position;
+
+	//the true desired route is the desired route plus the depot at the very end
+	const int desired_route_size = static_cast<int>(tour.size()) + 1;
+
+	const int depot = problem_definition.GetDepotNode().index;
+	CachedRoute &cached_route = scratch.cached_route;
+	bool recording_route = false;
+	int route_begin = 0;
+	int route_end = 0;
+	uint64_t route_hash = 0;
+	float route_start_time = 0.f;
+	
+	while(customer_nodes_serviced < desired_route_size)
+	{
+		//a route that starts at the depot with everything full only depends on its customers
+		const bool at_route_start = current_node_index == depot && current_inventory == max_inventory && current_battery == max_battery;
+		if(route_cache != nullptr && !verbose && at_route_start && customer_nodes_serviced < static_cast<int>(tour.size()))
+		{
+			route_begin = customer_nodes_serviced;
+			route_end = FindRouteEnd(tour, route_begin);
+			route_hash = RouteCache::HashRoute(tour.data() + route_begin, route_end - route_begin, GreedyCharging);
+			if(route_cache->Find(route_hash, tour.data() + route_begin, route_end - route_begin, cached_route))
+			{
+				//the same checks and checkpoints as driving the route, so the result doesn't depend on whether it was cached
+				for(const auto &checkpoint : cached_route.checkpoints)
+				{
+					full_distance = finished_distance + checkpoint.route_distance;
+					if(full_distance > cutoff) return {full_distance, false, true};
+					if(trace != nullptr)
+					{
+						trace->checkpoints.push_back({checkpoint.node, checkpoint.inventory, checkpoint.battery, full_distance, route_time + checkpoint.time, finished_distance, checkpoint.route_distance});
+					}
+				}
+				full_distance = finished_distance + cached_route.distance;
+				if(full_distance > cutoff) return {full_distance, false, true};
+
+				finished_distance = full_distance;
+				route_distance = 0.f;
+				customer_nodes_serviced = route_end;
+				if(route_end == static_cast<int>(tour.size()))
+				{
+					customer_nodes_serviced = desired_route_size;
+				}
+				else
+				{
+					route_time = RefuelingTime(cached_route.return_battery);
+				}
+				continue;
+			}
+
+			//a route with a customer the vehicle can't carry never gets back to the depot, so there's nothing to add
+			recording_route = route_end > route_begin;
+			route_start_time = route_time;
+			cached_route.checkpoints.clear();
+		}
+
+		const int desired_route_index = customer_nodes_serviced < static_cast<int>(tour.size()) ? tour[customer_nodes_serviced] : depot;
+		const Node &next_desired_node = problem_definition.GetNodeFromIndex(desired_route_index);
+		
+		const int demand_cost = next_desired_node.demand;
+		const float time_cost = next_desired_node.service_time;
+
+		const float ready_time = next_desired_node.ready_time;
+		const float due_time = next_desired_node.due_date;
+
+		if(verbose) cout << "I am currently at node " << current_node_index << " and my goal is to go to node " << desired_route_index << endl;
+		if(verbose) cout << "The next node has a demand cost of " << demand_cost << " and I have " << current_inventory << " inventory" << endl;
+		const RouteType route_type = demand_cost <= current_inventory ? RouteToCustomer : RouteToDepot;
+		const int destination = route_type == RouteToCustomer ? desired_route_index : problem_definition.GetDepotNode().index;
+
+		if(verbose)
+		{
+			if(route_type == RouteToCustomer) cout << "I am routing to customer " << desired_route_index << " because I have the inventory capacity" << endl;
+			else cout << "I need to stop at the depot before I go to customer " << desired_route_index << endl;
+		}
+
+		const PathfindingResult result = FindSafePath(current_node_index, destination, current_battery, scratch);
+		if(result == ImpossibleRoute)
+		{
+			if(verbose) cout << "=!=!= Impossible route detected after regular pathfinding =!=!=" << endl;
+			full_distance += INFEASIBLE_ROUTE_PENALTY;
+			return {full_distance, false, false};
+		}
+
+		const vector<int> &safe_route = scratch.safe_route;
+		for(size_t i = 1; i < safe_route.size(); i++)
+		{
+			const int from = safe_route[i-1];
+			const int to = safe_route[i];
+			if(verbose)
+			{
+				cout << "\tMy route has me going from node " << from << " to node " << to << endl;
+				scratch.padded_tour.push_back(to);
+			}
+			current_battery -= BatteryCost(from, to);
+			route_time += TimeCost(from, to);
+			route_distance += problem_definition.Distance(from, to);
+			if(problem_definition.GetNodeFromIndex(to).isCharger)
+			{
+				if(verbose) cout << "\t\tNode " << to << " is a charging station, so I need to fuel up" << endl;
+				route_time += RefuelingTime(current_battery);
+				current_battery = max_battery;
+			}
+		}
+		//every route is summed up on its own, so a route from the RouteCache adds the exact same distance
+		full_distance = finished_distance + route_distance;
+
+		//the distance can only grow from here, so the tour can't come in under the cutoff anymore
+		if(full_distance > cutoff)
+		{
+			if(verbose) cout << "The distance " << full_distance << " is already over the cutoff of " << cutoff << ", giving up on this tour" << endl;
+			return {full_distance, false, true};
+		}
+
+		if(route_type == RouteToCustomer)
+		{
+			//outside time window, bad
+			if(route_time < ready_time || route_time > due_time)
+			{
+				//add some route punishment
+				//full_distance += 10000;
+			}
+
+			route_time += time_cost;
+			current_node_index = desired_route_index;
+			current_inventory -= demand_cost;
+			
+			customer_nodes_serviced++;
+			if(trace != nullptr && customer_nodes_serviced <= static_cast<int>(tour.size()))
+			{
+				trace->checkpoints.push_back({current_node_index, current_inventory, current_battery, full_distance, route_time, finished_distance, route_distance});
+			}
+			if(recording_route && customer_nodes_serviced <= static_cast<int>(tour.size()))
+			{
+				cached_route.checkpoints.push_back({current_node_index, current_inventory, current_battery, route_distance, route_time - route_start_time, 0.f, route_distance});
+			}
+			if(customer_nodes_serviced == desired_route_size)
+			{
+				if(recording_route)
+				{
+					cached_route.distance = route_distance;
+					cached_route.return_battery = current_battery;
+					route_cache->Insert(route_hash, tour.data() + route_begin, route_end - route_begin, cached_route);
+				}
+				finished_distance = full_distance;
+				route_distance = 0.f;
+			}
+			if(verbose) cout << "I am now at node " << current_node_index << " and have serviced this customer" << endl;
+			assert(current_inventory >= 0);
+		}
+		else if(route_type == RouteToDepot)
+		{
+			if(recording_route)
+			{
+				assert(customer_nodes_serviced == route_end);
+				cached_route.distance = route_distance;
+				cached_route.return_battery = current_battery;
+				route_cache->Insert(route_hash, tour.data() + route_begin, route_end - route_begin, cached_route);
+				recording_route = false;
+			}
+			finished_distance = full_distance;
+			route_distance = 0.f;
+
+			current_node_index = depot;
+			//reset the route time, aka new vehicle leaving the depot at t = 0
+			route_time = 0;
+			current_inventory = max_inventory;
+			route_time += RefuelingTime(current_battery);
+			current_battery = max_battery;
+			if(verbose) cout << "I made it to the depot, and have refilled my inventory and my battery capacity" << endl;
+		}
+
+		assert(current_battery >= 0);
+		assert(current_inventory >= 0);
+		if(verbose) cout << "-------------------------------------------------------" << endl;
+	}
+
+	if(verbose)
+	{
+		cout << "----------------------------------------" << endl;
+		cout << "True route with distance " << full_distance << ": ";
+		for (const auto i : scratch.padded_tour)
+		{
+			cout << i << " ";
+		}
+		cout << endl;
+		cout << "----------------------------------------" << endl;
+	}
+	return {full_distance, true, false};
+}
+
+/**
+* Evaluates a tour with the optimal depot returns, the Split procedure of Prins (2004).
+* 
+* Every way of cutting the tour into consecutive runs of customers, each driven as its own route from the depot
+* and back with a full battery and a full load, is a path through an acyclic graph with a node per position in
+* the tour. The arc from position i to position j is the route that services customers i to j-1, and it only exists
+* if their demand fits in the vehicle and the vehicle can drive the route without getting stranded, taking the same
+* charging detours as Simulate, or the ones the ChargingPlanner finds with the OptimalCharging strategy. The shortest path from position 0 to the end of the tour is the best split,
+* and since all arcs point forward it is found with a single Bellman pass in tour order.
+* 
+* The route from position i is extended one customer at a time, so the cost of every arc out of i only takes
+* one more leg and one trial return to the depot, and the extension stops once the load doesn't fit anymore.
+* That makes the pass O(n b) for routes of at most b customers. The greedy split Simulate makes is one of the
+* paths through the graph, so the optimal split is never longer. Time windows are ignored, the same as in Simulate.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param cutoff Positions that can only be reached with a distance over the cutoff aren't extended, see Evaluate(tour, cutoff, scratch)
+* @param scratch Buffers owned by the calling thread, the labels of the graph are written to it
+* @param verbose Prints the routes of the split
+* 
+* @return The distance of the best split. If no split is feasible, the tour is ranked by its greedy simulation instead
+*/
+EvaluationResult RouteEvaluator::Split(const vector<int> &tour, const float cutoff, EvaluationScratch &scratch, const bool verbose) const
+{
+	const int tour_length = static_cast<int>(tour.size());
+	const int depot = problem_definition.GetDepotNode().index;
+	vector<float> &label = scratch.split_label;
+	vector<int> &predecessor = scratch.split_predecessor;
+	label.assign(tour_length + 1, numeric_limits<float>::infinity());
+	predecessor.assign(tour_length + 1, -1);
+	label[0] = 0.f;
+
+	//the shortest label that was left unextended because of the cutoff, which every complete split would have to go through
+	float smallest_pruned_label = numeric_limits<float>::infinity();
+
+	for(int i = 0; i < tour_length; i++)
+	{
+		if(label[i] == numeric_limits<float>::infinity()) continue;
+		if(label[i] > cutoff)
+		{
+			smallest_pruned_label = min(smallest_pruned_label, label[i]);
+			continue;
+		}
+
+		float battery, route_distance;
+		StartRoute(battery, route_distance, scratch);
+		int inventory = max_inventory;
+		int current_node_index = depot;
+		for(int j = i; j < tour_length; j++)
+		{
+			inventory -= problem_definition.GetNodeFromIndex(tour[j]).demand;
+			if(inventory < 0) break;
+			if(!ExtendRoute(current_node_index, tour[j], battery, route_distance, scratch)) break;
+			current_node_index = tour[j];
+
+			//every route that goes on from here is longer, so none of them can come in under the cutoff either
+			if(label[i] + route_distance > cutoff)
+			{
+				smallest_pruned_label = min(smallest_pruned_label, label[i] + route_distance);
+				break;
+			}
+
+			const float return_distance = RouteDistanceTo(current_node_index, depot, battery, route_distance, scratch);
+			if(return_distance == numeric_limits<float>::infinity()) continue;
+			if(label[i] + return_distance < label[j + 1])
+			{
+				label[j + 1] = label[i] + return_distance;
+				predecessor[j + 1] = i;
+			}
+		}
+	}
+
+	const float distance = label[tour_length];
+	if(distance <= cutoff)
+	{
+		if(verbose)
+		{
+			cout << "Optimal split with distance " << distance << ":" << endl;
+			vector<int> route_starts;
+			for(int k = tour_length; k > 0; k = predecessor[k])
+			{
+				route_starts.push_back(predecessor[k]);
+			}
+			reverse(route_starts.begin(), route_starts.end());
+			route_starts.push_back(tour_length);
+			for(size_t r = 0; r + 1 < route_starts.size(); r++)
+			{
+				cout << "\tRoute " << r << ": " << depot;
+				for(int k = route_starts[r]; k < route_starts[r + 1]; k++)
+				{
+					cout << " " << tour[k];
+				}
+				cout << " " << depot << endl;
+			}
+		}
+		return {distance, true, false};
+	}
+
+	//the best split either avoids every pruned label, and then it is the one found, or it is at least as long as the shortest pruned label
+	const float lower_bound = min(distance, smallest_pruned_label);
+	if(lower_bound != numeric_limits<float>::infinity()) return {lower_bound, false, true};
+
+	//no split gets the vehicle through, so the greedy one has to do for ranking the tour against other infeasible ones
+	if(charging_strategy == OptimalCharging) return PlanCharging(tour, cutoff, scratch, verbose);
+	const RouteCheckpoint depot_start = {depot, max_inventory, max_battery, 0.f, 0.f, 0.f, 0.f};
+	return Simulate(tour, depot_start, 0, cutoff, scratch, verbose, nullptr);
+}
+
+/**
+* Evaluates a tour with the same depot returns as Simulate, but with the charging stops of every route chosen by the
+* ChargingPlanner instead of one leg at a time. A route is planned as a whole, so the distance of the tour is only
+* known once the vehicle is back at the depot, but the shortest label of the current route plus the finished routes
+* is a lower bound on it along the way, which is what the cutoff is checked against. With a RouteCache, the distance
+* of every route is looked up before it is planned.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param cutoff The evaluation stops with a dominated result as soon as the lower bound goes over this
+* @param scratch Buffers owned by the calling thread, including its ChargingPlanner
+* @param verbose Prints the distance of every route
+* 
+* @return Returns the true distance of the tour and whether or not the route is feasible
+*/
+EvaluationResult RouteEvaluator::PlanCharging(const vector<int> &tour, const float cutoff, EvaluationScratch &scratch, const bool verbose) const
+{
+	ChargingPlanner &planner = scratch.charging_planner;
+	CachedRoute &cached_route = scratch.cached_route;
+	const int depot = problem_definition.GetDepotNode().index;
+	const bool use_cache = route_cache != nullptr && !verbose;
+	float finished_distance = 0.f;
+	int route_count = 0;
+
+	//the final return to the depot is the last leg, the same as in Simulate
+	for(int route_begin = 0; route_begin < static_cast<int>(tour.size()); route_count++)
+	{
+		//a customer the vehicle can't carry still gets a route of its own, the same as the first customer of any route
+		const int route_end = max(FindRouteEnd(tour, route_begin), route_begin + 1);
+		const uint64_t route_hash = use_cache ? RouteCache::HashRoute(tour.data() + route_begin, route_end - route_begin, OptimalCharging) : 0;
+
+		if(!use_cache || !route_cache->Find(route_hash, tour.data() + route_begin, route_end - route_begin, cached_route))
+		{
+			planner.StartRoute();
+			int current_node_index = depot;
+			for(int position = route_begin; position < route_end; position++)
+			{
+				if(!planner.Extend(current_node_index, tour[position]))
+				{
+					if(verbose) cout << "=!=!= Customer " << tour[position] << " can't be reached on route " << route_count << " =!=!=" << endl;
+					return {finished_distance + planner.GetShortestDistance() + INFEASIBLE_ROUTE_PENALTY, false, false};
+				}
+				current_node_index = tour[position];
+				if(finished_distance + planner.GetShortestDistance() > cutoff) return {finished_distance + planner.GetShortestDistance(), false, true};
+			}
+
+			cached_route.distance = planner.DistanceTo(current_node_index, depot);
+			if(cached_route.distance == numeric_limits<float>::infinity())
+			{
+				if(verbose) cout << "=!=!= Route " << route_count << " can't make it back to the depot =!=!=" << endl;
+				return {finished_distance + planner.GetShortestDistance() + INFEASIBLE_ROUTE_PENALTY, false, false};
+			}
+			if(verbose) cout << "Route " << route_count << " ends at customer " << current_node_index << " with a distance of " << cached_route.distance << endl;
+
+			//the battery the route ends with depends on the charging stops, and nothing after the depot needs it
+			cached_route.return_battery = 0.f;
+			cached_route.checkpoints.clear();
+			if(use_cache) route_cache->Insert(route_hash, tour.data() + route_begin, route_end - route_begin, cached_route);
+		}
+
+		finished_distance += cached_route.distance;
+		if(finished_distance > cutoff) return {finished_distance, false, true};
+		route_begin = route_end;
+	}
+
+	if(verbose) cout << "Tour with planned charging has " << route_count << " routes and a distance of " << finished_distance << endl;
+	return {finished_distance, true, false};
+}
+
+/**
+* Finds where the route that starts at the depot before customer route_begin ends, which is at the first customer
+* whose demand doesn't fit in the vehicle on top of the customers before it, the same as Simulate.
+* 
+* @param tour The index encoded tour through just the customer nodes.
+* @param route_begin The position in the tour of the first customer of the route
+* 
+* @return The position after the last customer of the route. If the first customer doesn't fit in an empty vehicle, that is route_begin
+*/
+int RouteEvaluator::FindRouteEnd(const vector<int> &tour, const int route_begin) const
+{
+	int load = 0;
+	int route_end = route_begin;
+	while(route_end < static_cast<int>(tour.size()) && load + problem_definition.GetNodeFromIndex(tour[route_end]).demand <= max_inventory)
+	{
+		load += problem_definition.GetNodeFromIndex(tour[route_end]).demand;
+		route_end++;
+	}
+	return route_end;
+}
+
+/**
+* Memoizes the routes of every tour evaluated from now on, see RouteCache. The cache is shared by all copies of
+* the evaluator, so it has to be enabled before the evaluator is copied or shared between threads.
+* 
+* @param capacity The most routes the cache holds, or 0 to stop caching routes
+*/
+void RouteEvaluator::EnableRouteCache(const size_t capacity)
+{
+	route_cache = capacity > 0 ? make_shared<RouteCache>(capacity) : nullptr;
+}
+
+const char *RouteEvaluator::GetSplitStrategyName(const SplitStrategy strategy)
+{
+	switch(strategy)
+	{
+	case GreedySplit: return "Greedy";
+	case OptimalSplit: return "Optimal";
+	}
+	return "Unknown";
+}
+
+const char *RouteEvaluator::GetChargingStrategyName(const ChargingStrategy strategy)
+{
+	switch(strategy)
+	{
+	case GreedyCharging: return "Greedy";
+	case OptimalCharging: return "Optimal";
+	}
+	return "Unknown";
+}
+
+/**
+* Starts a route at the depot for Split, with a full battery and nothing driven yet.
+*/
+void RouteEvaluator::StartRoute(float &battery_level, float &route_distance, EvaluationScratch &scratch) const
+{
+	battery_level = max_battery;
+	route_distance = 0.f;
+	if(charging_strategy == OptimalCharging) scratch.charging_planner.StartRoute();
+}
+
+/**
+* Drives on to the next customer of a route for Split. With greedy charging the vehicle takes the path FindSafePath
+* finds, with optimal charging the ChargingPlanner extends its labels and the distance becomes the shortest of them.
+* 
+* @return Whether the vehicle can get to the customer at all
+*/
+bool RouteEvaluator::ExtendRoute(const int from, const int to, float &battery_level, float &route_distance, EvaluationScratch &scratch) const
+{
+	if(charging_strategy == OptimalCharging)
+	{
+		if(!scratch.charging_planner.Extend(from, to)) return false;
+		route_distance = scratch.charging_planner.GetShortestDistance();
+		return true;
+	}
+	return DriveLeg(from, to, battery_level, route_distance, scratch);
+}
+
+/**
+* The distance of a route for Split if it ended by driving on to the given node, without changing the route.
+* 
+* @return The distance, or infinity if the vehicle can't get there
+*/
+float RouteEvaluator::RouteDistanceTo(const int from, const int to, float battery_level, float route_distance, EvaluationScratch &scratch) const
+{
+	if(charging_strategy == OptimalCharging) return scratch.charging_planner.DistanceTo(from, to);
+	return DriveLeg(from, to, battery_level, route_distance, scratch) ? route_distance : numeric_limits<float>::infinity();
+}
+
+/**
+ * \brief Finds a safe path from the start node to the end node, stopping at charging stations if needed.
+ * If the vehicle can't safely drive straight to the end node with its current battery, the shortest
+ * detour through the charger graph precomputed by the ProblemDefinition is used instead. Detours are
+ * looked up through the scratch buffer's DetourCache, since the same legs come up over and over again in a population.
+ * \param start The index of the node the vehicle is currently at
+ * \param end The index of the node the vehicle wants to get to
+ * \param battery_level The battery the vehicle has when leaving start
+ * \param scratch The path is written into scratch.safe_route, starting with start and ending with end
+ * \return Whether the path was direct, went through charging stations, or is impossible
+ */
+RouteEvaluator::PathfindingResult RouteEvaluator::FindSafePath(const int start, const int end, const float battery_level, EvaluationScratch &scratch) const
+{
+	vector<int> &path = scratch.safe_route;
+	path.clear();
+	path.push_back(start);
+
+	if(problem_definition.CanReachSafely(start, end, battery_level))
+	{
+		path.push_back(end);
+		return DirectPathFound;
+	}
+
+	const vector<int> *detour = scratch.detour_cache.FindDetour(start, end, battery_level);
+	if(detour == nullptr)
+	{
+		return ImpossibleRoute;
+	}
+
+	path.insert(path.end(), detour->begin(), detour->end());
+	path.push_back(end);
+	return RouteThroughChargers;
+}
+
+/**
+ * \brief Drives from the start node to the end node along the safe path FindSafePath finds, recharging at any charging stations on the way.
+ * \param start The index of the node the vehicle is currently at
+ * \param end The index of the node the vehicle wants to get to
+ * \param battery_level The battery the vehicle has when leaving start, updated to the battery it has when it arrives at end
+ * \param distance The distance driven is added to this
+ * \param scratch Buffers owned by the calling thread
+ * \return Whether the vehicle can make it to the end node at all. Nothing is updated if it can't
+ */
+bool RouteEvaluator::DriveLeg(const int start, const int end, float &battery_level, float &distance, EvaluationScratch &scratch) const
+{
+	//most legs don't need a charger, and those don't have to be written out as a path
+	if(problem_definition.CanReachSafely(start, end, battery_level))
+	{
+		battery_level -= BatteryCost(start, end);
+		distance += problem_definition.Distance(start, end);
+		return true;
+	}
+	if(FindSafePath(start, end, battery_level, scratch) == ImpossibleRoute) return false;
+
+	const vector<int> &safe_route = scratch.safe_route;
+	for(size_t i = 1; i < safe_route.size(); i++)
+	{
+		battery_level -= BatteryCost(safe_route[i-1], safe_route[i]);
+		distance += problem_definition.Distance(safe_route[i-1], safe_route[i]);
+		if(problem_definition.GetNodeFromIndex(safe_route[i]).isCharger) battery_level = max_battery;
+	}
+	return true;
+}
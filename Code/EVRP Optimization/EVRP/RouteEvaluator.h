@@ -0,0 +1,190 @@
+#pragma once
+#include <limits>
+#include <memory>
+
+#include "ChargingPlanner.h"
+#include "DetourCache.h"
+#include "ProblemDefinition.h"
+
+constexpr float INFEASIBLE_ROUTE_PENALTY = 1000000000.f; /*!< Added to the distance of a tour that would leave the vehicle stranded */
+constexpr float NO_EVALUATION_CUTOFF = numeric_limits<float>::infinity(); /*!< Cutoff that never stops an evaluation early */
+
+/**
+* How the RouteEvaluator decides where a tour is split into routes that each start and end at the depot.
+*/
+enum SplitStrategy
+{
+	GreedySplit, /*!< Drive the tour in order and only return to the depot when the next customer's demand doesn't fit, see RouteEvaluator::Simulate*/
+	OptimalSplit /*!< Return to the depot wherever that makes the whole tour shortest, see RouteEvaluator::Split*/
+};
+
+/**
+* How the RouteEvaluator decides where the vehicle stops to recharge on a route.
+*/
+enum ChargingStrategy
+{
+	GreedyCharging, /*!< Drive every leg directly if the vehicle arrives safely, otherwise take the shortest detour for that leg alone, see RouteEvaluator::FindSafePath*/
+	OptimalCharging /*!< Insert the charging stops that make each route as a whole shortest, see ChargingPlanner*/
+};
+
+/**
+* The result of simulating a tour. Infeasible tours still get a (heavily penalized) distance so that
+* they can be ranked against each other, but feasible is false for them.
+* 
+* If the tour was evaluated with a cutoff and the distance driven went over it, the simulation stops
+* right there and dominated is set. The distance is then only how far the vehicle got before it was
+* stopped, which is a lower bound on the true distance, and the rest of the tour was never checked for feasibility.
+*/
+struct EvaluationResult
+{
+	float distance;
+	bool feasible;
+	bool dominated;
+};
+
+/**
+* The state of the vehicle just before it sets off towards one of the customers in a tour.
+*/
+struct RouteCheckpoint
+{
+	int node; /*!< The index of the node the vehicle is at*/
+	int inventory; /*!< The inventory left in the vehicle*/
+	float battery; /*!< The battery left in the vehicle*/
+	float distance; /*!< The distance driven so far*/
+	float time; /*!< The time spent on the current route so far*/
+	float finished_distance; /*!< The distance of the routes before the current one*/
+	float route_distance; /*!< The distance driven on the current route so far, distance is this plus finished_distance*/
+};
+
+/**
+* Checkpoints recorded while evaluating a tour, where checkpoints[k] is the state of the vehicle before it heads
+* to the k-th customer and the last checkpoint is the state before the final return to the depot. The state before
+* customer k only depends on the first k customers, so any other tour that starts with those same k customers
+* can resume its simulation from checkpoints[k] instead of driving the shared prefix again. If the tour turned
+* out to be infeasible, the checkpoints stop at the customer that couldn't be reached.
+*
+* With the OptimalSplit strategy, where the vehicle is before customer k depends on the customers after it too,
+* and with the OptimalCharging strategy so does the battery it has left, so no checkpoints are recorded and
+* every evaluation simulates the whole tour.
+*/
+struct RouteTrace
+{
+	vector<RouteCheckpoint> checkpoints;
+};
+
+/**
+* The result of driving one route from the depot through a run of customers and back, with a full battery and load at the start, see RouteCache.
+*/
+struct CachedRoute
+{
+	float distance; /*!< The distance of the whole route, including the return to the depot*/
+	float return_battery; /*!< The battery left when the vehicle is back at the depot*/
+	vector<RouteCheckpoint> checkpoints; /*!< The state after every customer, with the time counted from the start of the route. Empty for routes planned with the OptimalCharging strategy*/
+};
+
+class RouteCache;
+
+/**
+* Everything the RouteEvaluator needs to write to while simulating a tour. The evaluator itself is
+* read-only, so any number of threads can share one as long as each thread has its own scratch buffer.
+* The buffers are reused between evaluations, so evaluating a tour doesn't allocate once they are warm.
+*/
+struct EvaluationScratch
+{
+	explicit EvaluationScratch(const ProblemDefinition *problem) : detour_cache(problem), charging_planner(problem) {}
+
+	DetourCache detour_cache; /*!< Memoized charging detours, see DetourCache*/
+	ChargingPlanner charging_planner; /*!< The labels of the route being planned with the OptimalCharging strategy*/
+	vector<int> safe_route; /*!< The path between two desired nodes, including any charging stations along the way*/
+	vector<int> padded_tour; /*!< The complete route actually driven, only recorded when verbose*/
+	vector<float> split_label; /*!< split_label[k] is the shortest distance that services the first k customers of the tour in complete routes, see RouteEvaluator::Split*/
+	vector<int> split_predecessor; /*!< The number of customers before the last route of the split that split_label[k] belongs to*/
+	CachedRoute cached_route; /*!< The route that was just looked up in or is about to be added to the RouteCache*/
+};
+
+/***************************************************************************//**
+ * Calculates the fitness of a tour by simulating an electric vehicle driving it.
+ *
+ * A tour is the order in which the customers should be visited. The evaluator figures out
+ * when the vehicle needs to detour to a charging station or return to the depot to restock,
+ * and returns the distance that is actually driven. All of the state of the simulation
+ * lives on the stack or in the caller's EvaluationScratch, so a single evaluator can be
+ * shared by every thread and every algorithm working on the same problem.
+ *
+ * By default the tour is driven greedily, returning to the depot only once the vehicle
+ * can't carry the next customer's demand anymore. With SetSplitStrategy(OptimalSplit) the
+ * depot returns are instead chosen to make the tour as short as possible, see Split.
+ * Likewise the vehicle only detours to a charger once the next leg would strand it, unless
+ * SetChargingStrategy(OptimalCharging) plans the charging stops of every route as a whole.
+ * The strategies have to be chosen before the evaluator is shared between threads.
+ *
+ * With EnableRouteCache, the routes the greedy split ends up with are memoized, so a route
+ * that has been driven before by any thread is looked up instead of simulated again, see RouteCache.
+ * Every route is summed up on its own before it is added to the distance of the tour, so a tour
+ * comes out at exactly the same distance whether its routes were looked up or not.
+ ******************************************************************************/
+class RouteEvaluator
+{
+public:
+	explicit RouteEvaluator(const ProblemDefinition &problem) : problem_definition(problem)
+	{
+		const VehicleParameters &params = problem.GetVehicleParameters();
+		max_battery = params.battery_capacity;
+		max_inventory = params.load_capacity;
+		battery_consumption_rate = params.battery_consumption_rate;
+		inverse_refueling_rate = params.inverse_recharging_rate;
+		average_velocity = params.average_velocity;
+	}
+
+	EvaluationResult Evaluate(const vector<int> &tour, EvaluationScratch &scratch, bool verbose = false) const;
+	EvaluationResult Evaluate(const vector<int> &tour, float cutoff, EvaluationScratch &scratch) const;
+	EvaluationResult EvaluateIncremental(const vector<int> &tour, const RouteTrace *prefix_trace, int shared_prefix, EvaluationScratch &scratch, RouteTrace &trace, float cutoff = NO_EVALUATION_CUTOFF) const;
+	const ProblemDefinition &GetProblem() const { return problem_definition; }
+
+	void SetSplitStrategy(const SplitStrategy strategy) { split_strategy = strategy; }
+	SplitStrategy GetSplitStrategy() const { return split_strategy; }
+	static const char *GetSplitStrategyName(SplitStrategy strategy);
+
+	void SetChargingStrategy(const ChargingStrategy strategy) { charging_strategy = strategy; }
+	ChargingStrategy GetChargingStrategy() const { return charging_strategy; }
+	static const char *GetChargingStrategyName(ChargingStrategy strategy);
+
+	void EnableRouteCache(size_t capacity);
+	RouteCache *GetRouteCache() const { return route_cache.get(); }
+
+private:
+	enum PathfindingResult
+	{
+		DirectPathFound,
+		RouteThroughChargers,
+		ImpossibleRoute
+	};
+	enum RouteType
+	{
+		RouteToCustomer,
+		RouteToDepot
+	};
+
+	EvaluationResult Simulate(const vector<int> &tour, const RouteCheckpoint &start, int start_position, float cutoff, EvaluationScratch &scratch, bool verbose, RouteTrace *trace) const;
+	EvaluationResult Split(const vector<int> &tour, float cutoff, EvaluationScratch &scratch, bool verbose) const;
+	int FindRouteEnd(const vector<int> &tour, int route_begin) const;
+	EvaluationResult PlanCharging(const vector<int> &tour, float cutoff, EvaluationScratch &scratch, bool verbose) const;
+	void StartRoute(float &battery_level, float &route_distance, EvaluationScratch &scratch) const;
+	bool ExtendRoute(int from, int to, float &battery_level, float &route_distance, EvaluationScratch &scratch) const;
+	float RouteDistanceTo(int from, int to, float battery_level, float route_distance, EvaluationScratch &scratch) const;
+	PathfindingResult FindSafePath(int start, int end, float battery_level, EvaluationScratch &scratch) const;
+	bool DriveLeg(int start, int end, float &battery_level, float &distance, EvaluationScratch &scratch) const;
+	float BatteryCost(int from, int to) const { return problem_definition.Distance(from, to) * battery_consumption_rate; }
+	float TimeCost(int from, int to) const { return problem_definition.Distance(from, to) * average_velocity; }
+	float RefuelingTime(const float battery_level) const { return (max_battery - battery_level) / inverse_refueling_rate; }
+
+	const ProblemDefinition &problem_definition;
+	float max_battery; /*!< The maximum battery capacity*/
+	int max_inventory; /*!< The maximum vehicle inventory capacity*/
+	float battery_consumption_rate; /*!< The rate in which the battery discharges over distance*/
+	float inverse_refueling_rate;
+	float average_velocity;
+	SplitStrategy split_strategy = GreedySplit; /*!< Where the tour is split into routes, see SetSplitStrategy*/
+	ChargingStrategy charging_strategy = GreedyCharging; /*!< Where the vehicle recharges, see SetChargingStrategy*/
+	shared_ptr<RouteCache> route_cache; /*!< The routes driven so far, or nullptr if they aren't cached. Shared by the copies of the evaluator, see EnableRouteCache*/
+};
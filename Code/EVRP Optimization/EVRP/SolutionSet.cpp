@@ -1,31 +1,57 @@
 ﻿#include "SolutionSet.h"
 
+#include <algorithm>
+#include <cassert>
+
 #include "HelperFunctions.h"
 
 solution SolutionSet::GetBestSolution() const
 {
-    if(!solution_set.empty())
+    if(num_solutions > 0)
     {
-        solution best = *solution_set.begin();
-        return best;
+        return GetSolution(GetBestIndex());
     }
     return solution{};
 }
 
 solution SolutionSet::GetRandomSolution() const
 {
-    if(!solution_set.empty())
+    if(num_solutions > 0)
     {
-        const int random_index = HelperFunctions::RandomNumberGenerator(0, static_cast<int>(solution_set.size())-1);
+        const int random_index = HelperFunctions::RandomNumberGenerator(0, num_solutions-1);
+        return GetSolution(random_index);
+    }
+
+    return solution{};
+}
 
-        auto it = solution_set.begin();
-        advance(it, random_index);
-        return *it;
+solution SolutionSet::GetRandomSolution(RandomGenerator &generator) const
+{
+    if(num_solutions > 0)
+    {
+        const int random_index = HelperFunctions::RandomNumberGenerator(0, num_solutions-1, generator);
+        return GetSolution(random_index);
     }
 
     return solution{};
 }
 
+/**
+* Copies a solution out of the set.
+*
+* @param index The row of the solution in the tour matrix
+*
+* @return A copy of the tour, its distance and its trace
+*/
+solution SolutionSet::GetSolution(const int index) const
+{
+    assert(index >= 0 && index < num_solutions);
+    const int *tour = GetTour(index);
+    solution sol(vector<int>(tour, tour + tour_length), distances[index]);
+    sol.trace = traces[index];
+    return sol;
+}
+
 float SolutionSet::GetMinimumDistance() const
 {
     return GetBestSolution().distance;
@@ -33,12 +59,102 @@ float SolutionSet::GetMinimumDistance() const
 
 float SolutionSet::GetAverageDistance() const
 {
+    float sum_all_distances = 0.f;
+    for(int i = 0; i < num_solutions; i++)
+    {
+        sum_all_distances += distances[i];
+    }
     return sum_all_distances / static_cast<float>(num_solutions);
 }
 
 void SolutionSet::AddSolutionToSet(const solution& sol)
 {
-    solution_set.emplace(sol);
-    sum_all_distances += sol.distance;
+    if(num_solutions == 0) tour_length = static_cast<int>(sol.tour.size());
+    assert(static_cast<int>(sol.tour.size()) == tour_length);
+
+    tours.resize(static_cast<size_t>(num_solutions + 1) * tour_length);
+    distances.resize(num_solutions + 1);
+    traces.resize(num_solutions + 1);
     num_solutions++;
+    SetSolution(num_solutions - 1, sol);
+}
+
+/**
+* Overwrites the solution in one row of the set. Different threads can fill different rows at the same time,
+* since nothing but that row is written to.
+*
+* @param index The row to overwrite, which must already exist, see Resize
+* @param sol The solution to copy into the row
+*/
+void SolutionSet::SetSolution(const int index, const solution &sol)
+{
+    assert(index >= 0 && index < num_solutions);
+    assert(static_cast<int>(sol.tour.size()) == tour_length);
+    copy(sol.tour.begin(), sol.tour.end(), tours.begin() + static_cast<size_t>(index) * tour_length);
+    distances[index] = sol.distance;
+    traces[index] = sol.trace;
+}
+
+/**
+* Grows or shrinks the set to the given number of solutions. Solutions that were already in the set keep their rows,
+* and new rows are empty until they are filled in with SetSolution.
+*
+* @param count The number of solutions in the set afterwards
+* @param length The length of every tour in the set
+*/
+void SolutionSet::Resize(const int count, const int length)
+{
+    assert(num_solutions == 0 || length == tour_length);
+    tour_length = length;
+    num_solutions = count;
+    tours.resize(static_cast<size_t>(count) * length);
+    distances.resize(count);
+    traces.resize(count);
+}
+
+/**
+* Empties the set, but keeps the storage so that refilling it doesn't allocate.
+*/
+void SolutionSet::Clear()
+{
+    tours.clear();
+    distances.clear();
+    traces.clear();
+    num_solutions = 0;
+}
+
+/**
+* Finds the solution with the lowest distance. If several solutions are tied, the one added first wins.
+*
+* @return The row of the best solution, or -1 if the set is empty
+*/
+int SolutionSet::GetBestIndex() const
+{
+    if(num_solutions == 0) return -1;
+    return static_cast<int>(min_element(distances.begin(), distances.begin() + num_solutions) - distances.begin());
+}
+
+/**
+* Finds the best solutions in the set with a partial sort, which is all that is needed when only the top few
+* are of interest, such as migrants or seed solutions.
+*
+* @param count The number of solutions wanted
+*
+* @return The rows of the min(count, size of the set) best solutions, best first. Ties go to the solution added first
+*/
+vector<int> SolutionSet::GetBestIndices(const int count) const
+{
+    vector<int> indices(num_solutions);
+    for(int i = 0; i < num_solutions; i++)
+    {
+        indices[i] = i;
+    }
+
+    const int best_count = max(0, min(count, num_solutions));
+    partial_sort(indices.begin(), indices.begin() + best_count, indices.end(), [this](const int a, const int b)
+    {
+        return distances[a] < distances[b] || (distances[a] == distances[b] && a < b);
+    });
+    indices.resize(best_count);
+    return indices;
 }
@@ -1,5 +1,5 @@
 ﻿#pragma once
-#include <set>
+#include <memory>
 
 #include "ProblemDefinition.h"
 
@@ -8,55 +8,56 @@ enum SolutionType
     DefaultSolution = -1
 };
 
+struct RouteTrace;
+
 struct solution
 {
-    vector<Node> tour;
+    vector<int> tour; /*!< The index encoded order of the customers, the Node data is looked up in the ProblemDefinition when it is needed*/
     float distance;
+    shared_ptr<const RouteTrace> trace; /*!< Checkpoints recorded when the tour was evaluated, if any. Shared between copies of the solution, see RouteEvaluator::EvaluateIncremental*/
 
-    solution(vector<Node> t = {}, float dist = DefaultSolution) : tour(std::move(t)), distance(dist) {}
-};
-
-struct CompareSolution
-{
-    bool operator()(const solution &a, const solution &b) const
-    {
-        return a.distance < b.distance;
-    }
+    solution(vector<int> t = {}, float dist = DefaultSolution) : tour(std::move(t)), distance(dist) {}
 };
 
+/**
+* A set of solutions, such as one generation of the Genetic Algorithm.
+* 
+* The tours are stored back to back in one contiguous tour matrix with one row per solution, next to a flat array
+* of their distances, so picking a random solution or scanning for the best one only walks over plain arrays. All of
+* the tours in a set have to be the same length. Clear and Resize keep the allocated storage, so a set that is reused
+* every generation stops allocating once it has grown to its full size.
+*/
 class SolutionSet
 {
 public:
-    SolutionSet()
-    {
-        solution_set.clear();
-        sum_all_distances = 0.f;
-        num_solutions = 0;
-    }
-
-    SolutionSet(const SolutionSet *other_solutions)
-    {
-        solution_set.clear();
-        sum_all_distances = 0.f;
-        num_solutions = 0;
-        for(const auto& sol : other_solutions->solution_set)
-        {
-            AddSolutionToSet(sol);
-        }
-    }
+    SolutionSet() = default;
+
+    SolutionSet(const SolutionSet *other_solutions) : SolutionSet(*other_solutions) {}
     
     
     solution GetBestSolution() const;
     solution GetRandomSolution() const;
+    solution GetRandomSolution(RandomGenerator &generator) const;
+    solution GetSolution(int index) const;
     float GetMinimumDistance() const;
     float GetAverageDistance() const;
     void AddSolutionToSet(const solution &sol);
+    void SetSolution(int index, const solution &sol);
+    void Resize(int count, int length);
+    void Clear();
+    int GetBestIndex() const;
+    vector<int> GetBestIndices(int count) const;
     int GetNumberOfSolutions() const { return num_solutions; }
-    multiset<solution, CompareSolution> GetSolutionSet() const { return solution_set; }
+    int GetTourLength() const { return tour_length; }
+    const int *GetTour(const int index) const { return tours.data() + static_cast<size_t>(index) * tour_length; }
+    float GetDistance(const int index) const { return distances[index]; }
+    const RouteTrace *GetTrace(const int index) const { return traces[index].get(); }
 
 private:
-    multiset<solution, CompareSolution> solution_set;
-    float sum_all_distances = 0.f;
+    vector<int> tours; /*!< The tour matrix, where row i holds the tour of solution i*/
+    vector<float> distances; /*!< The distance of each solution*/
+    vector<shared_ptr<const RouteTrace>> traces; /*!< The RouteTrace of each solution, if it has one*/
+    int tour_length = 0;
     int num_solutions = 0;
     
 };
@@ -0,0 +1,197 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+
+/**
+* Builds the tree over some of the nodes of a problem.
+*
+* @param all_nodes Every node of the problem, so the coordinates can be looked up by index
+* @param indices The indices of the nodes to put in the index, such as just the customers
+*/
+SpatialIndex::SpatialIndex(const vector<Node> &all_nodes, const vector<int> &indices)
+{
+	points.reserve(indices.size());
+	for (const int index : indices)
+	{
+		points.push_back({all_nodes[index].x, all_nodes[index].y, index});
+	}
+	alive.assign(points.size(), 0);
+	removed.assign(points.size(), false);
+	Build(0, static_cast<int>(points.size()), 0);
+
+	slot_of_index.assign(all_nodes.size(), -1);
+	for (size_t slot = 0; slot < points.size(); slot++)
+	{
+		slot_of_index[points[slot].index] = static_cast<int>(slot);
+	}
+}
+
+/**
+* Finds the node closest to a point. Ties go to the node with the lowest index.
+*
+* @param x The x coordinate to search around
+* @param y The y coordinate to search around
+* @param exclude The index of a node to leave out, such as the node the search is around, or -1
+* @param min_distance Nodes this close to the point or closer are left out too. Negative to leave none out
+*
+* @return The index of the closest node that hasn't been removed, or -1 if there is none
+*/
+int SpatialIndex::Nearest(const double x, const double y, const int exclude, const double min_distance) const
+{
+	vector<pair<double, int>> heap;
+	heap.reserve(2);
+	SearchNearest(0, static_cast<int>(points.size()), 0, x, y, 1, exclude, min_distance < 0 ? -1.0 : min_distance * min_distance, heap);
+	return heap.empty() ? -1 : heap.front().second;
+}
+
+/**
+* Finds the k nodes closest to a point. Ties go to the nodes with the lowest index.
+*
+* @param x The x coordinate to search around
+* @param y The y coordinate to search around
+* @param k The number of nodes to find. Fewer are returned if the index doesn't have that many
+* @param exclude The index of a node to leave out of the results, such as the node the search is around, or -1
+* @param out_indices Filled with the indices of the closest nodes that haven't been removed, closest first
+*/
+void SpatialIndex::KNearest(const double x, const double y, const int k, const int exclude, vector<int> &out_indices) const
+{
+	out_indices.clear();
+	if (k <= 0) return;
+
+	//a max-heap on the squared distance, so the worst of the k best candidates so far is always on top
+	vector<pair<double, int>> heap;
+	heap.reserve(k + 1);
+	SearchNearest(0, static_cast<int>(points.size()), 0, x, y, k, exclude, -1.0, heap);
+
+	sort_heap(heap.begin(), heap.end());
+	for (const auto &candidate : heap)
+	{
+		out_indices.push_back(candidate.second);
+	}
+}
+
+/**
+* Finds every node within a distance of a point, such as the charging stations a vehicle can reach with the battery it has left.
+*
+* @param x The x coordinate to search around
+* @param y The y coordinate to search around
+* @param radius The largest distance from the point a node can be at (inclusive)
+* @param out_indices Filled with the indices of the nodes in range that haven't been removed, in no particular order
+*/
+void SpatialIndex::WithinRadius(const double x, const double y, const double radius, vector<int> &out_indices) const
+{
+	out_indices.clear();
+	if (radius < 0) return;
+	SearchRadius(0, static_cast<int>(points.size()), 0, x, y, radius, out_indices);
+}
+
+/**
+* Takes a node out of every later search. Removing a node that isn't in the index or was already removed does nothing.
+*
+* @param index The index of the node to remove
+*/
+void SpatialIndex::Remove(const int index)
+{
+	if (index < 0 || index >= static_cast<int>(slot_of_index.size())) return;
+	const int slot = slot_of_index[index];
+	if (slot == -1 || removed[slot]) return;
+	removed[slot] = true;
+
+	//walk down from the root to the slot, since every range on the way contains it
+	int begin = 0;
+	int end = static_cast<int>(points.size());
+	while (true)
+	{
+		const int middle = begin + (end - begin) / 2;
+		alive[middle]--;
+		if (slot == middle) break;
+		if (slot < middle) end = middle;
+		else begin = middle + 1;
+	}
+}
+
+/**
+* Puts the median of a range of points in the middle of it, split on x at even depths and on y at odd ones,
+* and then does the same for the points on either side of the median.
+*/
+void SpatialIndex::Build(const int begin, const int end, const int depth)
+{
+	if (begin >= end) return;
+
+	const int middle = begin + (end - begin) / 2;
+	alive[middle] = end - begin;
+	if (end - begin == 1) return;
+
+	nth_element(points.begin() + begin, points.begin() + middle, points.begin() + end, [depth](const Point &a, const Point &b)
+	{
+		return depth % 2 == 0 ? a.x < b.x : a.y < b.y;
+	});
+	Build(begin, middle, depth + 1);
+	Build(middle + 1, end, depth + 1);
+}
+
+/**
+* Searches a range of the tree for points closer than the worst candidate in the heap. The side of the split the
+* query point is on is searched first, and the other side is only searched if the split line itself is no further
+* than the worst candidate, since nothing on the far side can be closer than the line.
+*/
+void SpatialIndex::SearchNearest(const int begin, const int end, const int depth, const double x, const double y, const int k, const int exclude,
+	const double min_squared_distance, vector<pair<double, int>> &heap) const
+{
+	if (begin >= end) return;
+
+	const int middle = begin + (end - begin) / 2;
+	if (alive[middle] == 0) return;
+
+	const Point &point = points[middle];
+	const double squared_distance = (point.x - x) * (point.x - x) + (point.y - y) * (point.y - y);
+	if (point.index != exclude && !removed[middle] && squared_distance > min_squared_distance)
+	{
+		const pair<double, int> candidate(squared_distance, point.index);
+		if (static_cast<int>(heap.size()) < k)
+		{
+			heap.push_back(candidate);
+			push_heap(heap.begin(), heap.end());
+		}
+		else if (candidate < heap.front())
+		{
+			pop_heap(heap.begin(), heap.end());
+			heap.back() = candidate;
+			push_heap(heap.begin(), heap.end());
+		}
+	}
+
+	const double split_distance = depth % 2 == 0 ? x - point.x : y - point.y;
+	const bool query_is_before = split_distance < 0;
+	if (query_is_before) SearchNearest(begin, middle, depth + 1, x, y, k, exclude, min_squared_distance, heap);
+	else SearchNearest(middle + 1, end, depth + 1, x, y, k, exclude, min_squared_distance, heap);
+
+	//the far side can still hold a point at the same distance as the worst candidate, which wins if its index is lower
+	if (static_cast<int>(heap.size()) < k || split_distance * split_distance <= heap.front().first)
+	{
+		if (query_is_before) SearchNearest(middle + 1, end, depth + 1, x, y, k, exclude, min_squared_distance, heap);
+		else SearchNearest(begin, middle, depth + 1, x, y, k, exclude, min_squared_distance, heap);
+	}
+}
+
+/**
+* Collects the points of a range of the tree within the radius, only descending into the sides of a split that the circle reaches.
+*/
+void SpatialIndex::SearchRadius(const int begin, const int end, const int depth, const double x, const double y, const double radius,
+	vector<int> &out_indices) const
+{
+	if (begin >= end) return;
+
+	const int middle = begin + (end - begin) / 2;
+	if (alive[middle] == 0) return;
+
+	const Point &point = points[middle];
+	if (!removed[middle] && (point.x - x) * (point.x - x) + (point.y - y) * (point.y - y) <= radius * radius)
+	{
+		out_indices.push_back(point.index);
+	}
+
+	const double split_distance = depth % 2 == 0 ? x - point.x : y - point.y;
+	if (split_distance <= radius) SearchRadius(begin, middle, depth + 1, x, y, radius, out_indices);
+	if (split_distance >= -radius) SearchRadius(middle + 1, end, depth + 1, x, y, radius, out_indices);
+}
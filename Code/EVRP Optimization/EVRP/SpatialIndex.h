@@ -0,0 +1,50 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "ProblemDefinition.h"
+
+/***************************************************************************//**
+ * A 2-d tree over the coordinates of a set of nodes, for nearest neighbor and range queries.
+ *
+ * The tree is implicit: the points are stored in one array, ordered so that the median
+ * of every range (split alternately on x and y) sits in the middle of it, with the points
+ * before it on one side of the split and the points after it on the other. Building it
+ * takes O(n log n), and a k-nearest query visits O(k + log n) points on typical inputs
+ * instead of all n of them.
+ *
+ * Nodes can be removed from the index, such as customers that have already been visited by a
+ * constructive heuristic. Every subtree keeps count of the nodes in it that haven't been removed,
+ * so removing a node takes O(log n) and searches skip subtrees that have been emptied entirely.
+ *
+ * Queries only read the tree, so any number of threads can query the same index as long as
+ * nobody is removing nodes from it at the same time.
+ ******************************************************************************/
+class SpatialIndex
+{
+public:
+	SpatialIndex(const vector<Node> &all_nodes, const vector<int> &indices);
+
+	int Nearest(double x, double y, int exclude, double min_distance = -1.0) const;
+	void KNearest(double x, double y, int k, int exclude, vector<int> &out_indices) const;
+	void WithinRadius(double x, double y, double radius, vector<int> &out_indices) const;
+	void Remove(int index);
+	int Size() const { return alive.empty() ? 0 : alive[points.size() / 2]; }
+
+private:
+	struct Point
+	{
+		double x;
+		double y;
+		int index;
+	};
+
+	void Build(int begin, int end, int depth);
+	void SearchNearest(int begin, int end, int depth, double x, double y, int k, int exclude, double min_squared_distance, vector<pair<double, int>> &heap) const;
+	void SearchRadius(int begin, int end, int depth, double x, double y, double radius, vector<int> &out_indices) const;
+
+	vector<Point> points;
+	vector<int> alive; /*!< For the range of points a point is the median of, how many of them haven't been removed*/
+	vector<bool> removed; /*!< Whether the point in each slot has been removed*/
+	vector<int> slot_of_index; /*!< The slot in #points of every node index in the index, -1 for the others*/
+};
@@ -0,0 +1,102 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+/**
+* Starts num_workers - 1 background threads. The thread that calls ParallelFor runs as worker 0.
+*
+* @param num_workers The total number of workers, including the calling thread. Values below 1 use DefaultWorkerCount()
+*/
+ThreadPool::ThreadPool(const int num_workers)
+{
+	worker_count = num_workers < 1 ? DefaultWorkerCount() : num_workers;
+	for (int worker = 1; worker < worker_count; worker++)
+	{
+		threads.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(pool_mutex);
+		stopping = true;
+	}
+	job_ready.notify_all();
+	for (auto &t : threads)
+	{
+		t.join();
+	}
+}
+
+/**
+* Runs task(worker, index) for every index in [0, count) and waits until all of them are done.
+*
+* @param count The number of indices to process
+* @param task The work to do for a single index. It receives the worker running it, in [0, GetWorkerCount())
+*/
+void ThreadPool::ParallelFor(const int count, const function<void(int worker, int index)> &task)
+{
+	if (threads.empty())
+	{
+		RunBlock(0, count, task);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(pool_mutex);
+		current_task = &task;
+		current_count = count;
+		pending_workers = static_cast<int>(threads.size());
+		job_id++;
+	}
+	job_ready.notify_all();
+
+	RunBlock(0, count, task);
+
+	unique_lock<mutex> lock(pool_mutex);
+	job_done.wait(lock, [this] { return pending_workers == 0; });
+	current_task = nullptr;
+}
+
+int ThreadPool::DefaultWorkerCount()
+{
+	return max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+void ThreadPool::WorkerLoop(const int worker)
+{
+	long long last_job = 0;
+	while (true)
+	{
+		unique_lock<mutex> lock(pool_mutex);
+		job_ready.wait(lock, [&] { return stopping || job_id != last_job; });
+		if (stopping) return;
+
+		last_job = job_id;
+		const function<void(int, int)> *task = current_task;
+		const int count = current_count;
+		lock.unlock();
+
+		RunBlock(worker, count, *task);
+
+		lock.lock();
+		if (--pending_workers == 0)
+		{
+			job_done.notify_one();
+		}
+	}
+}
+
+/**
+* Runs this worker's contiguous block of indices.
+*/
+void ThreadPool::RunBlock(const int worker, const int count, const function<void(int, int)> &task) const
+{
+	const long long begin = static_cast<long long>(count) * worker / worker_count;
+	const long long end = static_cast<long long>(count) * (worker + 1) / worker_count;
+	for (long long i = begin; i < end; i++)
+	{
+		task(worker, static_cast<int>(i));
+	}
+}
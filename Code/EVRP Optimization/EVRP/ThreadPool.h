@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/***************************************************************************//**
+ * A persistent pool of worker threads for data-parallel loops.
+ *
+ * The threads are created once and then sleep between jobs, so a ParallelFor costs a
+ * wake-up instead of a thread creation. The thread calling ParallelFor takes part in the
+ * work as worker 0. Indices are split into contiguous, equally sized blocks, one per worker,
+ * so the same index is always handled by the same worker for a given worker count. This
+ * makes it possible to give each worker its own random number stream and scratch buffers
+ * and still get reproducible results.
+ ******************************************************************************/
+class ThreadPool
+{
+public:
+	explicit ThreadPool(int num_workers);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	void ParallelFor(int count, const function<void(int worker, int index)> &task);
+	int GetWorkerCount() const { return worker_count; }
+
+	static int DefaultWorkerCount();
+
+private:
+	void WorkerLoop(int worker);
+	void RunBlock(int worker, int count, const function<void(int, int)> &task) const;
+
+	int worker_count;
+	vector<thread> threads;
+
+	mutex pool_mutex;
+	condition_variable job_ready;
+	condition_variable job_done;
+	const function<void(int, int)> *current_task = nullptr;
+	int current_count = 0;
+	int pending_workers = 0;
+	long long job_id = 0;
+	bool stopping = false;
+};